@@ -18,7 +18,7 @@
 \******************************************************************************/
 
 /******************************************************************************\
- * Beschreibung fr HsKa_Logo, QUADRATISCHE_SPIRALE, SPIRALE und radieren/lschen:          *
+ * Beschreibung fr HsKa_Logo, QUADRATISCHE_SPIRALE und SPIRALE (Radieren siehe unten):     *
  *                                                                                          *
  * int x[] gibt an wie viele Werte in dem Array Positionsanfahrt_y enthalten sind.          *
  * Ist zum Beispiel x[5] = 133, so sind in Positionsanfahrt_y [5][133] Werte enthalten.     *
@@ -47,6 +47,7 @@
 /***Header-Dateien*************************************************************/
 #include "xc.h"
 #include <stdio.h>
+#include <math.h>
 /******************************************************************************/
 
 /***CONFIG*********************************************************************/
@@ -67,6 +68,199 @@
 #pragma config JTAGEN = OFF             // JTAG Port Enable (JTAG port is disabled)
 /******************************************************************************/
 
+/***Zeitbasis******************************************************************/
+// Timer2/3 laufen als 32-Bit-Timer mit festem Vorteiler 1:8 frei durch
+// (2 us je Takt bei Fcy = 4 MHz, berlauf nach etwa 2,4 Stunden). ZEIT()
+// liefert diese monotone Zeit. Schritte werden nicht mehr ab "Timer auf 0"
+// gewartet, sondern gegen einen absoluten Termin geplant (Termin += Dauer).
+// Gewartet wird vor jeder Flanke (TERMIN_WARTEN, dann Ports schreiben), die
+// Rechenzeit dazwischen fllt in die Wartezeit und summiert sich nicht auf.
+#define TAKTE_PRO_MS            500UL
+#define ENTPRELLEN              (20*TAKTE_PRO_MS)
+#define FLANKE_SPIEL            4       // so viele Takte spt kehrt WARTEN_BIS pnktlich zurck
+/******************************************************************************/
+
+/***Sicherung (emuliertes EEPROM)**********************************************/
+// Der Fortschritt eines Musters (Muster, k, i, j und absolute Position) wird
+// alle SICHERUNG_INTERVALL im Programmspeicher abgelegt, aber nur nach einem
+// RESET (ohne Referenz kann an der Position nicht fortgesetzt werden). Die
+// Eintrge werden reihum in SICHERUNG_PAGES Flash-Pages geschrieben, Wort fr
+// Wort in den Wartezeiten zwischen den Schritten (WARTEN_BIS). Ein Eintrag ist
+// erst gltig, wenn als letztes Wort die Kennung geschrieben wurde.
+// Gelscht wird nur bei stehenden Motoren (SICHERUNG_VORBEREITEN in
+// ABSCHALTEN): alle Pages auer der mit dem neuesten Eintrag, die nicht leer
+// sind. Damit ist jede Page einmal pro Umlauf gelscht und ein Muster hat
+// mindestens SICHERUNG_PAGES-1 Pages frei. Ist trotzdem kein Platz mehr,
+// fllt die Sicherung bis zum Ende des Musters aus.
+#define MUSTER_KEINS            0
+#define MUSTER_HSKA_LOGO        1
+#define MUSTER_SPIRALE          2
+#define MUSTER_QUADRATISCH      3
+#define MUSTER_RADIEREN         4
+#define MUSTER_EXTERN           5       // k = Nummer im SPI-Flash
+
+#define FLASH_PAGE              512     // Befehlsworte pro Flash-Page
+#define SICHERUNG_PAGES         4
+#define SICHERUNG_WORTE         8       // Befehlsworte pro Eintrag
+#define SICHERUNG_PRO_PAGE      (FLASH_PAGE/SICHERUNG_WORTE)
+#define SICHERUNG_EINTRAEGE     (SICHERUNG_PAGES*SICHERUNG_PRO_PAGE)
+#define SICHERUNG_KENNUNG       0xA55A  // Eintrag vollstndig geschrieben
+#define SICHERUNG_INTERVALL     (10000*TAKTE_PRO_MS)    // 10 s zwischen zwei Sicherungen
+#define SICHERUNG_WORT_TAKTE    25      // ein Wort programmieren (hchstens 50 us)
+
+typedef struct
+{
+    int Muster;
+    int k;                      // Index in x_richtung[] (Radieren: Teilstck)
+    int i;                      // Index in Positionsanfahrt_y[k][] (Radieren: Art)
+    int j;                      // Schritt innerhalb des Teilstcks
+    int X;                      // absolute Position beim Schritt j
+    int Y;
+} SICHERUNG;
+
+const unsigned int Sicherung_Flash[SICHERUNG_PAGES*FLASH_PAGE] __attribute__((space(prog), aligned(FLASH_PAGE*2))) = {[0 ... SICHERUNG_PAGES*FLASH_PAGE-1] = 0xFFFF};
+/******************************************************************************/
+
+/***Geschwindigkeit je Teilstck*********************************************/
+// Die Delay-Werte der Muster gelten nur noch fr die engsten Stellen. Die
+// Teilstcke selbst werden mit der Motorgrenze DELAY_MOTOR gefahren. An jeder
+// Ecke bestimmt ECKE_DELAY aus dem Knickwinkel eine Delay zwischen
+// DELAY_MOTOR (gerade weiter) und Delay_max (90 und mehr), auf die in den
+// letzten ECKE_SCHRITTE vor der Ecke gebremst und von der in den ersten
+// ECKE_SCHRITTE danach wieder beschleunigt wird (Kugel wird sonst
+// mitgerissen). Jede Ecke wird nur einmal berechnet, das Ende eines
+// Teilstcks ist der Anfang des nchsten. Anfang und Ende eines Musters und
+// das Fortsetzen mitten in einem Teilstck sind Stillstand und bekommen wie
+// 90 Delay_max. In Teilstcken mit Schnell-Durchlufen kommt die schnelle
+// Achse einmal je Delay (DELAY_BEGRENZEN), auch in den normalen Durchlufen
+// dahinter, die deshalb mit der halben Delay laufen. Rampen und Eck-Delays
+// gelten je Phase von FAHREN, in Schnell-Durchlufen also doppelt.
+// Keine Achse darf an einer Ecke ihre Geschwindigkeit strker ndern als
+// beim Anfahren aus dem Stillstand mit DELAY_STILLSTAND (Start-Stopp-
+// Frequenz der Motoren). Hlt eine Achse an, fhrt sie an oder kehrt sie um,
+// hebt ECKE_DELAY die Delay dafr an, auch ber Delay_max. Reichen die
+// Durchlufe eines kurzen Teilstcks nicht fr seine Rampen, hlt
+// SPRUNG_BEGRENZEN die Grenze von Durchlauf zu Durchlauf ein.
+#define DELAY_MOTOR             80      // kleinste Delay ohne Schnell
+#define DELAY_STILLSTAND        (2*DELAY_MOTOR)     // aus dem bzw. in den Stillstand
+#define ECKE_SCHRITTE           64      // Bremsen bzw. Beschleunigen an einer Ecke
+/******************************************************************************/
+
+/***Externer Musterspeicher (SPI-Flash)****************************************/
+// Weitere Muster liegen in einem SPI-NOR-Flash an SPI1 (SCK1 RF6, SDI1 RF7,
+// SDO1 RF8, CS RF2). Aufbau des Abbilds (16-Bit-Werte little-endian):
+//   Adresse 0:      EXTERN_KENNUNG, Anzahl Muster, danach je Muster die
+//                   Startadresse (32 Bit)
+//   Musteranfang:   LED, Delay_max, Anzahl Teilstcke
+//   je Teilstck:   delta X, delta Y, Delay (0 = Motorgrenze, Ecken nach ECKE_DELAY)
+// Delay_max und Delay werden auf hchstens EXTERN_DELAY_MAX begrenzt (damit
+// rechnet ECKE_DELAY ohne berlauf), delta -32768 auf -32767.
+// Das Verzeichnis wird beim Einschalten gelesen. Ohne Kennung (leeres oder
+// fremdes Flash) gibt es keine Muster, ein Eintrag, dessen Muster nicht ganz
+// im Flash liegt, wird gesperrt (Startadresse 0). Beim Fahren werden die
+// Teilstcke in zwei Puffern gehalten: aus dem vorderen wird gelesen, der
+// hintere wird in den Warteschleifen von FAHREN byteweise nachgeladen, damit
+// der SPI-Transfer nie einen Schritt verzgert. Gestartet wird ber UART2:
+// 'M' fhrt das nchste Muster (reihum).
+#define EXTERN_CS               LATFbits.LATF2
+#define EXTERN_MUSTER_MAX       32
+#define EXTERN_KENNUNG          0x5053  // "SP"
+#define EXTERN_GROESSE          0x00100000UL    // 8 Mbit
+#define EXTERN_VERZEICHNIS      4       // Bytes vor den Startadressen
+#define EXTERN_KOPF             6       // Bytes Musterkopf
+#define EXTERN_TEILSTUECK       6       // Bytes je Teilstck
+#define EXTERN_PUFFER           (16*EXTERN_TEILSTUECK)
+#define EXTERN_DELAY_MAX        2000    // Kreuz*Delay_max in ECKE_DELAY < 2^31
+/******************************************************************************/
+
+/***Schrittverlust (Drift)****************************************************/
+// Vor dem Radieren und zwischen den Mustern aus dem SPI-Flash wird die
+// gemerkte Position mit den Referenzschaltern (PORTE 0x08 = X, 0x04 = Y)
+// verglichen. Drift = gemerkte Position - wahre Position in Schritten, die
+// Werte stehen in Statistik und werden kurz auf den LEDs angezeigt. Ein
+// '?' ber UART2 gibt die Statistik aus (nur im Stillstand).
+#define OFFSET_SCHRITTE         100     // Abstand Nullpunkt - Referenzschalter
+#define DRIFT_KORRIGIEREN       1       // 1 = gemerkte Position berichtigen
+#define DRIFT_MAX               400     // Schalter nicht gefunden: Abbruch
+#define DRIFT_LANGSAM           200     // ab hier mit RESET-Geschwindigkeit
+
+typedef struct
+{
+    unsigned int Extern_Warten;     // Pufferwechsel musste auf SPI-Flash warten
+    unsigned int Drift_Pruefungen;
+    int Drift_X;                    // Ergebnis der letzten Prfung
+    int Drift_Y;
+    int Drift_X_Max;                // grter Betrag seit dem Einschalten
+    int Drift_Y_Max;
+    long Drift_X_Summe;
+    long Drift_Y_Summe;
+} STATISTIK;
+/******************************************************************************/
+
+/***Joggen*********************************************************************/
+// Stopp-Taste lnger als 1 s halten: Joggen. Solange RD0/RD1 (X+/X-) bzw.
+// RD2/RD3 (Y+/Y-) gedrckt sind, fhrt der Schlitten mit konstanter
+// Beschleunigung bis zur Motorgrenze, beim Loslassen wird ebenso gebremst.
+// Die Tasten werden vor jedem Schritt gelesen. ber UART2 (9600 Baud)
+// gehen die Befehle R/L (X+/X-), V/H (Y+/Y-), S (Halt) und E (Ende), sie
+// mssen alle JOG_HALTEN wiederholt werden. Nach RESET wird nur zwischen
+// 0 und X_MAX/Y_MAX gefahren, die Bremsstrecke wird dabei bercksichtigt.
+#define X_MAX                   11200   // Softwareendlagen in Schritten
+#define Y_MAX                   11200
+#define JOG_X_PLUS              0x01    // entspricht RD0 ... RD3
+#define JOG_X_MINUS             0x02
+#define JOG_Y_PLUS              0x04
+#define JOG_Y_MINUS             0x08
+#define JOG_DELAY_START         1000    // Delay des ersten Schritts
+#define JOG_RAMPE               48      // Stufen der Rampe, ab etwa 40 an der Motorgrenze
+#define JOG_HALTEN              (100*TAKTE_PRO_MS)  // je UART-Befehl
+/******************************************************************************/
+
+/***Radieren*******************************************************************/
+// Die Radierbahn wird erzeugt statt gespeichert. Der Bahnabstand ergibt sich
+// aus Kugelbreite und berlappung. Zur Wahl stehen Raster (Bahnen in
+// y-Richtung), Spirale von auen nach innen und von innen nach auen. Jede
+// Ecke wird mit einem Viertelkreis (Radius = halber Bahnabstand) aus kurzen
+// Sehnen verrundet, am Ende einer Rasterbahn ergibt das einen Halbkreis. So
+// bleibt der Knick je Teilstck klein und ECKE_DELAY muss nicht auf die
+// langsamste Delay gehen. Vor dem Start wird die Dauer jeder Art aus
+// Bahnlnge, Zahl der Ecken und Anfahrt geschtzt (RADIEREN_DAUER, ohne die
+// Bahn zu erzeugen) und die schnellste genommen. Die Sehnen werden vorher
+// einmal als ganze Zahlen berechnet, beim Fahren gibt es kein sin/cos.
+#define RADIEREN_KUGEL          250     // Kugelbreite in Schritten
+#define RADIEREN_UEBERLAPP      20      // berlappung benachbarter Bahnen in %
+#define RADIEREN_ABSTAND        (RADIEREN_KUGEL*(100-RADIEREN_UEBERLAPP)/100)
+#define RADIEREN_SEHNEN         4       // Sehnen je Viertelkreis
+#define RADIEREN_DELAY_MAX      1000
+#define RADIEREN_ECKE_TAKTE     135000UL    // Bogen und Rampen einer Ecke (gemessen, 0,27 s)
+#define RADIEREN_EINS_BITS      10      // Sehnen_sin/Sehnen_cos: 1.0 = 1024
+#define RADIEREN_EINS           (1 << RADIEREN_EINS_BITS)
+#define RADIEREN_RASTER         0       // Art = Strategie*4 + Ecke
+#define RADIEREN_SPIRALE_INNEN  1
+#define RADIEREN_SPIRALE_AUSSEN 2
+
+typedef struct
+{
+    int Art;                        // Strategie*4 + Ecke (Bit0: x = X_MAX, Bit1: y = Y_MAX)
+    int Vorzeichen_x;               // Spiegelung entsprechend der Start-Ecke
+    int Vorzeichen_y;
+    int Radius;                     // Radius der Eckenverrundung
+    int Sehnen_sin[RADIEREN_SEHNEN + 1];    // Punkte des Viertelkreises (RADIEREN_EINS)
+    int Sehnen_cos[RADIEREN_SEHNEN + 1];
+    char Abbruch;
+    int Nummer;                     // Nummer des nchsten Teilstcks
+    int k_Start;                    // Fortsetzen ab Teilstck k_Start, Schritt j_Start
+    int j_Start;
+    int Richtung;                   // offener Schenkel: 0 = +x, 1 = +y, 2 = -x, 3 = -y
+    int Rest;                       // noch nicht ausgegebene Lnge des Schenkels
+    char Schenkel_offen;
+    int Delay_Ecke;                 // Ecke vor dem offenen Teilstck (ECKE_DELAY)
+    int Offen_x;                    // wartet auf seinen Nachfolger
+    int Offen_y;
+    char Teil_offen;
+} RADIERBAHN;
+/******************************************************************************/
+
 /***Prototyp*******************************************************************/ 
 int RESET_X_RICHTUNG(void);
 int RESET_Y_RICHTUNG(void);
@@ -79,54 +273,187 @@ int HsKa_Logo(void);
 int SPIRALE(void); 
 int QUADRATISCHE_SPIRALE(void);
 void ABSCHALTEN (void);
+int SEGMENT_FAHREN(int Delta_x, int Delta_y, int Delay, int Delay_Anfang, int Delay_Ende, char LED, int j_Start);
+int ECKE_DELAY(int A_x, int A_y, int B_x, int B_y, int Delay_max);
+void ECKE_ANTEIL(int Delta_x, int Delta_y, int Ende, int *Anteil_x, int *Anteil_y);
+int SPRUNG_BEGRENZEN(int Delay, int Anteil_x, int Anteil_y);
+void SPRUNG_GRENZEN(int Alt, int Neu, long *Unten, long *Oben);
+int SCHLEIFE_BERECHNEN(int Positionsanfahrt_x, int Positionsanfahrt_y, int *X_Schleife, int *Y_Schleife);
+int DELAY_BEGRENZEN(int Delay, int X_Schleife, int Y_Schleife);
+void RADIEREN_ERZEUGEN(int Art);
+unsigned long RADIEREN_DAUER(int Art);
+void RADIEREN_START(int Art, int *Start_x, int *Start_y);
+int SPIRALE_SCHENKEL(int n);
+void SCHENKEL(int Richtung, int Laenge);
+void SCHENKEL_ENDE(void);
+void GERADE(int Richtung, int Laenge);
+void BOGEN(int Richtung_alt, int Richtung_neu, int Radius);
+void TEIL(int Delta_x, int Delta_y);
+void TEIL_FAHREN(int Nach_x, int Nach_y);
+int ANFAHREN(int Ziel_x, int Ziel_y);
+int FORTSETZEN_ANBIETEN(void);
+void FORTSCHRITT_BEGINNEN(int Muster, int *k_Start, int *i_Start, int *j_Start);
+void SICHERUNG_PRUEFEN(void);
+void SICHERUNG_LOESCHEN(void);
+int SICHERUNG_LESEN(SICHERUNG *Ziel);
+int SICHERUNG_BEGINNEN(SICHERUNG *Quelle);
+void SICHERUNG_WEITER(void);
+void SICHERUNG_ABSCHLIESSEN(void);
+void SICHERUNG_VORBEREITEN(void);
+unsigned int FLASH_WORT_LESEN(unsigned int Index);
+void FLASH_WORT_SCHREIBEN(unsigned int Index, unsigned int Wert);
+void FLASH_PAGE_LOESCHEN(unsigned int Page);
+int FLASH_PAGE_LEER(unsigned int Page);
+int MUSTER_EXTERN_FAHREN(int Nummer);
+void EXTERN_INIT(void);
+unsigned char EXTERN_BYTE(unsigned char Senden);
+void EXTERN_ADRESSE(unsigned long Adresse);
+int EXTERN_OEFFNEN(int Nummer, int i_Start, char *LED, int *Delay_max);
+void EXTERN_SCHLIESSEN(void);
+void EXTERN_NACHLADEN(void);
+void EXTERN_TEILSTUECK_HOLEN(int *Delta_x, int *Delta_y, int *Delay);
+int DRIFT_PRUEFEN(int Korrigieren);
+int DRIFT_ACHSE(char Sensor, int *Position, int *Drift, int Korrigieren);
+int JOGGEN(void);
+void ZEIT_INIT(void);
+unsigned long ZEIT(void);
+void WARTEN_BIS(unsigned long Ziel);
+void TERMIN_WARTEN(unsigned int Dauer);
+void WARTEN_MS(unsigned int Millisekunden);
+int TASTE(unsigned int Maske);
+char JOG_GRENZEN(char Wunsch, int Bremsweg);
+void UART_INIT(void);
+int UART_LESEN(void);
+void UART_SENDEN(const char *Text);
+void STATISTIK_AUSGEBEN(void);
+/******************************************************************************/
+
+/***Globale Variablen**********************************************************/
+unsigned long Termin = 0;       // nchster Schritt-Termin (ZEIT)
+unsigned long Flanke = 0;       // Zeit der letzten Flanke (ZEIT)
+int Letzte_Phase = 0;           // Phase des letzten FAHREN als Eck-Delay, 0 = Stillstand
+int Letzter_Anteil_X = 0;       // halbe Schritte je zwei Phasen im letzten FAHREN (Betrag wie ECKE_ANTEIL)
+int Letzter_Anteil_Y = 0;
+int Position_X = 0;             // absolute Position in Schritten, 0 nach RESET
+int Position_Y = 0;
+SICHERUNG Fortschritt = {MUSTER_KEINS};     // aktuell laufendes Muster
+SICHERUNG Fortsetzung = {MUSTER_KEINS};     // hier soll das Muster weiterlaufen
+unsigned long Sicherung_Termin = 0;     // nchste Sicherung (ZEIT)
+int Sicherung_Platz = -1;       // nchster freier Eintrag (-1 = noch nicht gesucht)
+unsigned int Sicherung_Laufnummer = 0;
+unsigned int Sicherung_Daten[SICHERUNG_WORTE];  // Eintrag, der gerade geschrieben wird
+unsigned int Sicherung_Basis = 0;
+int Sicherung_Wort = SICHERUNG_WORTE;   // nchstes Wort davon (SICHERUNG_WORTE = fertig)
+unsigned long Extern_Index[EXTERN_MUSTER_MAX];  // Startadressen im SPI-Flash
+int Extern_Anzahl = 0;          // Anzahl Muster im SPI-Flash
+int Extern_Naechstes = 0;       // wird mit 'M' ber UART2 gestartet
+unsigned char Extern_Puffer[2][EXTERN_PUFFER];
+int Extern_Vorne = 0;           // aus diesem Puffer wird gelesen
+int Extern_Lesen = 0;           // Leseposition im vorderen Puffer
+int Extern_Laenge = 0;          // gltige Bytes im vorderen Puffer
+int Extern_Fuellstand = 0;      // geladene Bytes im hinteren Puffer
+unsigned long Extern_Rest = 0;  // noch nicht geladene Bytes des Musters
+char Extern_Unterwegs = 0;      // 1 = ein Byte wird gerade bertragen
+char Referenziert = 0;          // 1 = Position nach RESET bekannt
+char Stopp_gesperrt = 1;        // 1 = Stopp-Taste seit dem letzten ABSCHALTEN nicht losgelassen
+STATISTIK Statistik = {0};
+RADIERBAHN Bahn;
+const int Richtung_x[4] = {1, 0, -1, 0};   // Einheitsvektoren zu Bahn.Richtung
+const int Richtung_y[4] = {0, 1, 0, -1};
 /******************************************************************************/
 
 /***Programm*******************************************************************/
 int main(void) 
 {      
+    unsigned long Ende;
+    int Zeichen;
+    
     LATA  = 0x0000;             // LEDs auswhlen
     TRISA = 0x0000;             // LEDs beim start des Programms 
     PORTA = 0x0000;             // auf 0 setzen  
     TRISD = 0x0040;             // Taster auf lesen stellen
     
+    ZEIT_INIT();
+    EXTERN_INIT();
+    UART_INIT();
     ABSCHALTEN();
     while(1)
     {   
         ////////////////////////////////////////////////////////////////////////
         // Tasten Auslesen und Programm Starten
         
-        if((PORTD & 0x10) == 0x10) // Reset-Taste   RD4 
-        {    
-            RESET();
+        if(TASTE(0x10) == 1)      // Reset-Taste   RD4
+        {
+            if(RESET() == 1)
+            {
+                ABSCHALTEN();
+                FORTSETZEN_ANBIETEN();
+            }
             ABSCHALTEN();
         }
         
-/*        if((PORTD & 0x20) == 0x20) // Stopp-Taste   RD5
+        if((PORTD & 0x20) == 0x00)
+        {
+            Stopp_gesperrt = 0;     // Stopp nach einer Fahrt oder einem Abbruch losgelassen
+        }
+        if((Stopp_gesperrt == 0) && (TASTE(0x20) == 1))   // Stopp-Taste   RD5: lang = Joggen, startet nie eine Fahrt
+        {
+            Ende = ZEIT() + 1000*TAKTE_PRO_MS;
+            while(((PORTD & 0x20) == 0x20) && ((long)(ZEIT() - Ende) < 0))
+            {
+                //warten bis losgelassen, hchstens 1 s
+            }
+            if((PORTD & 0x20) == 0x20)
+            {
+                JOGGEN();
+                ABSCHALTEN();
+            }
+        }
+        
+        Zeichen = UART_LESEN();
+        if(Zeichen == 'J')          // Joggen ber UART2
+        {
+            JOGGEN();
+            ABSCHALTEN();
+        }
+        if((Zeichen == 'M') && (Extern_Anzahl > 0))     // nchstes Muster aus dem SPI-Flash ber UART2
         {
-      
+            if(DRIFT_PRUEFEN(DRIFT_KORRIGIEREN) == 0)
+            {
+                MUSTER_EXTERN_FAHREN(Extern_Naechstes);
+            }
+            Extern_Naechstes = (Extern_Naechstes + 1) % Extern_Anzahl;
+            ABSCHALTEN();
+        }
+        if(Zeichen == '?')          // Statistik ber UART2
+        {
+            STATISTIK_AUSGEBEN();
         }
-*/       
-        if((PORTD & 0x01) == 0x01) // HsKa-Logo    RD0  
+        
+        if(TASTE(0x01) == 1)      // HsKa-Logo    RD0
         {
             HsKa_Logo();
             ABSCHALTEN();
         }
         
-        if((PORTD & 0x02) == 0x02) // Spirale   RD1 
+        if(TASTE(0x02) == 1)      // Spirale   RD1
         {
             SPIRALE();
             ABSCHALTEN();
         }
         
-        if((PORTD & 0x04) == 0x04) // Quadratische-Spirale      RD2
+        if(TASTE(0x04) == 1)      // Quadratische-Spirale      RD2
         {
             QUADRATISCHE_SPIRALE();
             ABSCHALTEN();
         }
         
-        if((PORTD & 0x08) == 0x08) // Lschen      RD3
+        if(TASTE(0x08) == 1)      // Lschen      RD3
         {
-            Radieren();
+            if(DRIFT_PRUEFEN(DRIFT_KORRIGIEREN) == 0)
+            {
+                Radieren();
+            }
             ABSCHALTEN();
         }
     } 
@@ -135,6 +462,7 @@ int main(void)
 
 int RESET(void)
 {
+    Referenziert = 0;
     RESET_X_RICHTUNG(); 
     if((PORTD & 0x20) == 0x20) // Stopp-Taste   RD5
     {
@@ -148,7 +476,10 @@ int RESET(void)
     }
     
     OFFSET();
-    return 0;
+    Position_X = 0;                         // Nullpunkt nach dem Referenzieren
+    Position_Y = 0;
+    Referenziert = 1;
+    return 1;
 }
 int RESET_X_RICHTUNG(void)
 {
@@ -157,7 +488,7 @@ int RESET_X_RICHTUNG(void)
     TRISA = 0x0000;                         // PORTA auf schreiben stellen
     LATA  = 0x0000;                         // LED's ansteuern
     TRISB = 0x0000;                         // PORTB auf schreiben stellen
-    T1CON = 0x8010;                         // Einstellung Timer 1
+    Termin = ZEIT();
     
     while(1)
     {   
@@ -172,15 +503,10 @@ int RESET_X_RICHTUNG(void)
             return 0;
         }
         
+        TERMIN_WARTEN(500);                 // 1 ms je Flanke
         PORTG = 0x4000;                     // PUL = 1;
         //PORTA = 0x00FF;                     // LED's an
         PORTB = 0x8080;                     // ENA = 1; DIR = 0;
-        TMR1 = 0;                           // Reset Timer 1
-        
-        while (TMR1 < 500)
-        {
-            //warten
-        }
         
         if((PORTE & 0x08) == 0x08)                 // Taste Maskieren          
         {                                           // Stop Bedingung
@@ -193,15 +519,10 @@ int RESET_X_RICHTUNG(void)
             return 0;
         }
         
+        TERMIN_WARTEN(500);                 // 1 ms je Flanke
         PORTG = 0x0000;                     // PUL = 0;
         //PORTA = 0x0000;                     // LED's aus
         PORTB = 0x8000;                     // ENA = 1; DIR = 0;
-        TMR1 = 0;                           // Reset Timer 1
-        
-        while (TMR1 < 500)
-        {
-            //warten
-        } 
     }
     return 0;
 }
@@ -213,7 +534,7 @@ int RESET_Y_RICHTUNG(void)
     TRISA = 0x0000;                         // PORTA auf schreiben stellen
     LATA  = 0x0000;                         // LED's ansteuern
     TRISB = 0x0000;                         // PORTB auf schreiben stellen
-    T1CON = 0x8010;                         // Einstellung Timer 1
+    Termin = ZEIT();
     
     while(1)
     {   
@@ -228,15 +549,10 @@ int RESET_Y_RICHTUNG(void)
             return 0;
         }
         
+        TERMIN_WARTEN(500);                 // 1 ms je Flanke
         PORTG = 0x1000;                     // PUL = 1;
         //PORTA = 0x00FF;                     // LED's an
         PORTB = 0x4040;                     // ENA = 1; ; DIR = 0;
-        TMR1 = 0;                           // Reset Timer 1
-        
-        while (TMR1 < 500)
-        {
-            //warten
-        }
         
         if((PORTE & 0x04) == 0x04)                  // Taste Maskieren
         {                                           // Stop Bedingung
@@ -249,15 +565,10 @@ int RESET_Y_RICHTUNG(void)
             return 0;
         }
         
+        TERMIN_WARTEN(500);                 // 1 ms je Flanke
         PORTG = 0x0000;                     // PUL = 0;
         //PORTA = 0x0000;                     // LED's aus
         PORTB = 0x4000;                     // ENA = 1; DIR = 0;
-        TMR1 = 0;                           // Reset Timer 1
-        
-        while (TMR1 < 500)
-        {
-            //warten
-        } 
     }   
     return 0;
 }
@@ -275,7 +586,7 @@ int OFFSET()
     unsigned int X_Schnell = 0;
     unsigned int Y_Schnell = 0;
     
-    for(i=0; i < 100;i++) 
+    for(i=0; i < OFFSET_SCHRITTE;i++) 
     {
         FAHREN(Delay, LED, X_DIR, X_PUL, Y_DIR, Y_PUL, X_Schnell, Y_Schnell);
     }
@@ -295,213 +606,143 @@ int FAHREN(int Delay, char LED, char X_DIR, char X_PUL, char Y_DIR, char Y_PUL,
         x = 1;
     }
     
-    T1CON = 0x8010;                         // Einstellung Timer 1
-    
+    TERMIN_WARTEN(Delay/x);                             // auf den Termin warten, nchsten planen
     PORTG = 0x0000 | (X_PUL<<8) | (Y_PUL<<8);           // PUL = 1 oder 0
     PORTB = 0xc000 | (X_DIR<<8) | (Y_DIR<<8);           // ENA ist immer 1, DIR = 1 oder 0
     PORTA = LED;                                        // LED ansteuern
-    TMR1 = 0;                                           // Reset Timer 1  
-    while (TMR1 < (Delay/x))
-    {
-        //warten
-    }
     
     if(X_Schnell == 1)
     {
+        TERMIN_WARTEN(Delay/2);                         // auf den Termin warten, nchsten planen
         PORTG = 0x0000 | (Y_PUL<<8);                    // Y_PUL = 1 oder 0, X_PUL = 0
         PORTB = 0xc000 | (X_DIR<<8) | (Y_DIR<<8);       // ENA ist immer 1, DIR = 1 oder 0
         PORTA = LED;                                        // LED ansteuern
-        TMR1 = 0;                                       // Reset Timer 1  
-        while (TMR1 < (Delay/2))
-        {
-            //warten
-        }
     }
     if(Y_Schnell == 1)
     {
+        TERMIN_WARTEN(Delay/2);                         // auf den Termin warten, nchsten planen
         PORTG = 0x0000 | (X_PUL<<8);                    // X_PUL = 1 oder 0, Y_PUL = 0
         PORTB = 0xc000 | (X_DIR<<8) | (Y_DIR<<8);       // ENA ist immer 1, DIR = 1 oder 0
         PORTA = LED;                                        // LED ansteuern
-        TMR1 = 0;
-        while (TMR1 < (Delay/2))
-        {
-            //warten
-        }
     }
     if((X_Schnell == 1)|| (Y_Schnell == 1))
     {
+        TERMIN_WARTEN(Delay/2);                         // auf den Termin warten, nchsten planen
         PORTG = 0x0000 | (X_PUL<<8) | (Y_PUL<<8);       // PUL = 1 oder 0
         PORTB = 0xc000 | (X_DIR<<8) | (Y_DIR<<8);       // ENA ist immer 1, DIR = 1 oder 0
         PORTA = LED;                                        // LED ansteuern
-        TMR1 = 0;                                       // Reset Timer 1  
-        while (TMR1 < (Delay/2))
-        {
-            //warten
-        }
     }
     
+    TERMIN_WARTEN(Delay/x);                             // auf den Termin warten, nchsten planen
     PORTG = 0x0000;                                     // PUL = 0
     PORTB = 0xc000 | (X_DIR<<8) | (Y_DIR<<8);           // ENA ist immer 1, DIR = 1 oder 0
     PORTA = LED;                                        // LED ansteuern
-    TMR1 = 0;                                           // Reset Timer 1 
-    while (TMR1 < (Delay/x))
+
+    Letzte_Phase = Delay/x;                             // in Schnell-Durchlufen halbe Delay
+    Letzter_Anteil_X = 0;
+    Letzter_Anteil_Y = 0;
+    if(X_PUL != 0)
     {
-        //warten
+        Letzter_Anteil_X = 2 - Y_Schnell;               // Schnell: 2 fr die schnelle, 1 fr die andere Achse
+    }
+    if(Y_PUL != 0)
+    {
+        Letzter_Anteil_Y = 2 - X_Schnell;
+    }
+    
+    //////////////////////////////////////////////Absolute Position mitfhren
+    if(X_PUL != 0)                                      // bei X_Schnell zwei Pulse
+    {
+        if(X_DIR != 0)
+        {
+            Position_X += 1 + X_Schnell;
+        }
+        else
+        {
+            Position_X -= 1 + X_Schnell;
+        }
+    }
+    if(Y_PUL != 0)                                      // bei Y_Schnell zwei Pulse
+    {
+        if(Y_DIR != 0)
+        {
+            Position_Y += 1 + Y_Schnell;
+        }
+        else
+        {
+            Position_Y -= 1 + Y_Schnell;
+        }
     }
     return 0;
 }
 
 int Radieren(void)
 {
-    char X_PUL,X_DIR,Y_PUL,Y_DIR;
-    char LED = 0x00;
-
-    int k,i,j;  
-    int Delay = 0, Delay_1 = 80, Delay_2 = 1000;
-    int Schleife, X_Schleife=0, Y_Schleife=0, X_Schnell=0, Y_Schnell=0;
-    int Positionsanfahrt_x;  // ist der Puffer fr x_richtung
-    int x = 1;
-    int x_richtung[113] = { 0,200,0,200,0,200,0,200,0,200,
-                            0,200,0,200,0,200,0,200,0,200,
-                            0,200,0,200,0,200,0,200,0,200,
-                            0,200,0,200,0,200,0,200,0,200,
-                            0,200,0,200,0,200,0,200,0,200,
-                            0,200,0,200,0,200,0,200,0,200,
-                            0,200,0,200,0,200,0,200,0,200,
-                            0,200,0,200,0,200,0,200,0,200,
-                            0,200,0,200,0,200,0,200,0,200,
-                            0,200,0,200,0,200,0,200,0,200,
-                            0,200,0,200,0,200,0,200,0,200,
-                            0,200,0};
-    
-    int Positionsanfahrt_y[113][1]={{ 11200},{0},{-11200},{0},{ 11200},{0},{-11200},{0},{ 11200},{0},
-                                    {-11200},{0},{ 11200},{0},{-11200},{0},{ 11200},{0},{-11200},{0},
-                                    { 11200},{0},{-11200},{0},{ 11200},{0},{-11200},{0},{ 11200},{0},
-                                    {-11200},{0},{ 11200},{0},{-11200},{0},{ 11200},{0},{-11200},{0},
-                                    { 11200},{0},{-11200},{0},{ 11200},{0},{-11200},{0},{ 11200},{0},
-                                    {-11200},{0},{ 11200},{0},{-11200},{0},{ 11200},{0},{-11200},{0},
-                                    { 11200},{0},{-11200},{0},{ 11200},{0},{-11200},{0},{ 11200},{0},
-                                    {-11200},{0},{ 11200},{0},{-11200},{0},{ 11200},{0},{-11200},{0},
-                                    { 11200},{0},{-11200},{0},{ 11200},{0},{-11200},{0},{ 11200},{0},
-                                    {-11200},{0},{ 11200},{0},{-11200},{0},{ 11200},{0},{-11200},{0},
-                                    { 11200},{0},{-11200},{0},{ 11200},{0},{-11200},{0},{ 11200},{0},
-                                    {-11200},{0},{ 11200}}; 
+    int k_Start = 0, Art = -1, j_Start = 0;
+    int n, Nah, Start_x, Start_y, Anfahrt_x, Anfahrt_y;
+    unsigned long Dauer, Kuerzeste = 0;
     
     TRISG = 0x0000;                         // PORTG auf schreiben stellen
     TRISA = 0x0000;                         // PORTA auf schreiben stellen
     LATA  = 0x0000;                         // LED's ansteuern
     TRISB = 0x0000;                         // PORTB auf schreiben stellen
     TRISE = 0x00cc;                         // Sensoren
-   
-    for(k=0;k < 113;k++)
+    
+    FORTSCHRITT_BEGINNEN(MUSTER_RADIEREN, &k_Start, &Art, &j_Start);
+    if(Art < 0)                             // neu beginnen: Art whlen
     {
-        for(i=0;i < x;i++)
+        if(Referenziert == 0)
         {
-            
-            if(x_richtung[k] == 0)  // y-richtung soll schneller fahren als x-richtung
-            {
-                Delay = Delay_1;    //schneller    
-            }
-            else
-            {
-                Delay = Delay_2;    //langsamer
-            }
-            ///////////////////////////////////////////////////////Bestimmung der Richtung
-            if(x_richtung[k]< 0)
-            {
-                X_DIR = 0x00;
-                Positionsanfahrt_x = (-1)*x_richtung[k];
-            }
-            else
-            {
-                X_DIR = 0x08;
-                Positionsanfahrt_x = x_richtung[k];
-            }
-            if(Positionsanfahrt_y[k][i] < 0)
+            Art = RADIEREN_RASTER*4;        // Position unbekannt: Raster ab hier
+        }
+        else
+        {
+            Nah = 0;                        // nchstgelegene Ecke
+            if(Position_X > X_MAX/2)
             {
-                Y_DIR = 0x00; 
-                Positionsanfahrt_y[k][i] = (-1)*Positionsanfahrt_y[k][i];
+                Nah |= 0x01;
             }
-            else
+            if(Position_Y > Y_MAX/2)
             {
-                Y_DIR = 0x04;
+                Nah |= 0x02;
             }
-            //////////////////////////////////////////////Bestimmung der Wiederholungszahl
-            if(Positionsanfahrt_y[k][i] >= Positionsanfahrt_x)
+            for(n=RADIEREN_RASTER;n <= RADIEREN_SPIRALE_AUSSEN;n++)
             {
-                X_Schleife = 0;
-                Y_Schleife = Positionsanfahrt_y[k][i] - Positionsanfahrt_x;
-                if(Y_Schleife > Positionsanfahrt_x)
+                RADIEREN_START(n*4 + Nah, &Start_x, &Start_y);
+                Anfahrt_x = Start_x - Position_X;
+                Anfahrt_y = Start_y - Position_Y;
+                if(Anfahrt_x < 0)
                 {
-                    Y_Schleife = Positionsanfahrt_x;
+                    Anfahrt_x = (-1)*Anfahrt_x;
                 }
-                Schleife = Positionsanfahrt_y[k][i] - Y_Schleife;
-            }
-            else
-            {
-                Y_Schleife = 0;
-                X_Schleife = Positionsanfahrt_x - Positionsanfahrt_y[k][i];
-                if(X_Schleife > Positionsanfahrt_x/2)
+                if(Anfahrt_y < 0)
                 {
-                    X_Schleife = Positionsanfahrt_x/2;
-                    Schleife = Positionsanfahrt_x/2;
+                    Anfahrt_y = (-1)*Anfahrt_y;
                 }
-                else
+                Dauer = RADIEREN_DAUER(n*4 + Nah);
+                Dauer += 600UL*(Anfahrt_x + Anfahrt_y);     // ANFAHREN: Delay 300 je Achse
+                if((Art < 0) || (Dauer < Kuerzeste))
                 {
-                    Schleife = Positionsanfahrt_y[k][i];
+                    Art = n*4 + Nah;
+                    Kuerzeste = Dauer;
                 }
             }
-        
-            for(j=0;j<Schleife;j++)
+            RADIEREN_START(Art, &Start_x, &Start_y);
+            if(ANFAHREN(Start_x, Start_y) == 1)
             {
-                if((PORTD & 0x20) == 0x20)                  // Taste Maskieren
-                {                                           // Stop Bedingung
-                    return 0;
-                }
-            
-                if(j<Positionsanfahrt_x)
-                {
-                    X_PUL = 0x40;
-                }
-                else
-                {
-                    X_PUL = 0x00;
-                }
-            
-                if(j<Positionsanfahrt_y[k][i])
-                {
-                    Y_PUL = 0x10;
-                }
-                else
-                {
-                    Y_PUL = 0x00;
-                }
-            
-                if(j < X_Schleife)
-                {
-                    X_Schnell = 1;
-                }
-                else
-                {
-                    X_Schnell = 0;
-                }
-            
-                if(j < Y_Schleife)
-                {
-                    Y_Schnell = 1;
-                }
-                else
-                {
-                    Y_Schnell = 0;
-                }
-                if((((PORTE) & 0x40) == 0x40) || (((PORTE) & 0x80) == 0x80) || (((PORTE) & 0x08) == 0x08) || (((PORTE) & 0x04) == 0x04) || ((PORTD & 0x20) == 0x20))              // Taste Maskieren
-                {                                           // Stop Bedingung
-                    return 0;
-                }
-                FAHREN(Delay, LED, X_DIR, X_PUL, Y_DIR, Y_PUL, X_Schnell, Y_Schnell);
+                return 0;
             }
-        } 
+        }
+    }
+    
+    Bahn.k_Start = k_Start;
+    Bahn.j_Start = j_Start;
+    RADIEREN_ERZEUGEN(Art);
+    if(Bahn.Abbruch == 1)
+    {
+        return 0;                           // Abbruch, Sicherung bleibt erhalten
     }
+    SICHERUNG_LOESCHEN();
     return 0;
 }
 
@@ -527,13 +768,12 @@ int PROGRAMM(int Muster) // wird nicht ben
 
 int HsKa_Logo(void)
 {
-    char X_PUL,X_DIR,Y_PUL,Y_DIR;
     char LED = 0x03;
 
-    int k,i,j;  
-    int Delay = 500;
-    int Schleife,X_Schleife=0, Y_Schleife=0, X_Schnell=0, Y_Schnell=0;
-    int Positionsanfahrt_x;  // ist der Puffer fr x_richtung
+    int k,i;
+    int k_Start = 0, i_Start = 0, j_Start = 0;
+    int Delay_Anfang, Delay_Ende, Delay_max = 500;     // Delay_max: engste Stelle
+    int Nach_x, Nach_y;
     int x_richtung[14] = {0,5587,-50,7314,0,-20,-20,50,-10,-15,-5,40,-20,-16};//Schritte fr x-richtung
     int x[14] = {1,1,97,1,1,133,150,140,134,164,164,141,118,154};    //Schleifendurchlauf(ist fr die Anzahl der Werte im Array Positionsanfahrt_y)
     int Positionsanfahrt_y[14][164] =   {{11200},
@@ -558,113 +798,52 @@ int HsKa_Logo(void)
     TRISB = 0x0000;                         // PORTB auf schreiben stellen
     TRISE = 0x00cc;                         // Sensoren
    
-    for(k=0;k < 14;k++)
+    FORTSCHRITT_BEGINNEN(MUSTER_HSKA_LOGO, &k_Start, &i_Start, &j_Start);
+    Delay_Anfang = ECKE_DELAY(0, 0, 0, 0, Delay_max);      // aus dem Stillstand, auch beim Fortsetzen
+    for(k=k_Start;k < 14;k++)
     {
-        for(i=0;i < x[k];i++)
+        for(i=i_Start;i < x[k];i++)
         {
-            ///////////////////////////////////////////////////////Bestimmung der Richtung
-            if(x_richtung[k]< 0)
-            {
-                X_DIR = 0x00;
-                Positionsanfahrt_x = (-1)*x_richtung[k];
-            }
-            else
+            if(i+1 < x[k])                         // nchstes Teilstck
             {
-                X_DIR = 0x08;
-                Positionsanfahrt_x = x_richtung[k];
+                Nach_x = x_richtung[k];
+                Nach_y = Positionsanfahrt_y[k][i+1];
             }
-            if(Positionsanfahrt_y[k][i] < 0)
+            else if(k+1 < 14)
             {
-                Y_DIR = 0x00; 
-                Positionsanfahrt_y[k][i] = (-1)*Positionsanfahrt_y[k][i];
+                Nach_x = x_richtung[k+1];
+                Nach_y = Positionsanfahrt_y[k+1][0];
             }
             else
             {
-                Y_DIR = 0x04;
+                Nach_x = 0;
+                Nach_y = 0;
             }
-            //////////////////////////////////////////////Bestimmung der Wiederholungszahl
-            if(Positionsanfahrt_y[k][i] >= Positionsanfahrt_x)
-            {
-                X_Schleife = 0;
-                Y_Schleife = Positionsanfahrt_y[k][i] - Positionsanfahrt_x;
-                if(Y_Schleife > Positionsanfahrt_x)
-                {
-                    Y_Schleife = Positionsanfahrt_x;
-                }
-                Schleife = Positionsanfahrt_y[k][i] - Y_Schleife;
-            }
-            else
-            {
-                Y_Schleife = 0;
-                X_Schleife = Positionsanfahrt_x - Positionsanfahrt_y[k][i];
-                if(X_Schleife > Positionsanfahrt_x/2)
-                {
-                    X_Schleife = Positionsanfahrt_x/2;
-                    Schleife = Positionsanfahrt_x/2;
-                }
-                else
-                {
-                    Schleife = Positionsanfahrt_y[k][i];
-                }
-            }
-        
-            for(j=0;j<Schleife;j++)
-            {
-                if(j<Positionsanfahrt_x)
-                {
-                    X_PUL = 0x40;
-                }
-                else
-                {
-                    X_PUL = 0x00;
-                }
-            
-                if(j<Positionsanfahrt_y[k][i])
-                {
-                    Y_PUL = 0x10;
-                }
-                else
-                {
-                    Y_PUL = 0x00;
-                }
-            
-                if(j < X_Schleife)
-                {
-                    X_Schnell = 1;
-                }
-                else
-                {
-                    X_Schnell = 0;
-                }
+            Delay_Ende = ECKE_DELAY(x_richtung[k], Positionsanfahrt_y[k][i], Nach_x, Nach_y, Delay_max);
             
-                if(j < Y_Schleife)
-                {
-                    Y_Schnell = 1;
-                }
-                else
-                {
-                    Y_Schnell = 0;
-                }
-                if((((PORTE) & 0x40) == 0x40) || (((PORTE) & 0x80) == 0x80) || (((PORTE) & 0x08) == 0x08) || (((PORTE) & 0x04) == 0x04) || ((PORTD & 0x20) == 0x20))              // Taste Maskieren
-                {                                           // Stop Bedingung
-                    return 0;
-                }
-                FAHREN(Delay, LED, X_DIR, X_PUL, Y_DIR, Y_PUL, X_Schnell, Y_Schnell);
+            Fortschritt.k = k;
+            Fortschritt.i = i;
+            if(SEGMENT_FAHREN(x_richtung[k], Positionsanfahrt_y[k][i], DELAY_MOTOR, Delay_Anfang, Delay_Ende, LED, j_Start) == 1)
+            {
+                return 0;                           // Abbruch, Sicherung bleibt erhalten
             }
-        } 
+            j_Start = 0;
+            Delay_Anfang = Delay_Ende;              // gleiche Ecke, nicht neu rechnen
+        }
+        i_Start = 0;
     }
+    SICHERUNG_LOESCHEN();
     return 0;
 }
 
 int SPIRALE(void)
 {
-    char X_PUL,X_DIR,Y_PUL,Y_DIR;
     char LED = 0x0c;
 
-    int k,i,j; 
-    int Delay = 300;
-    int Schleife,X_Schleife=0, Y_Schleife=0, X_Schnell=0, Y_Schnell=0;
-    int Positionsanfahrt_x;  // ist der Puffer fr x_richtung
+    int k,i;
+    int k_Start = 0, i_Start = 0, j_Start = 0;
+    int Delay_Anfang, Delay_Ende, Delay_max = 300;     // Delay_max: engste Stelle
+    int Nach_x, Nach_y;
     int x_richtung[10] = {0,28,-25,30,-20,20,-20,20,-10,5};
     int x[10] = {1,400,396,288,372,313,250,183,244,248};
     int Positionsanfahrt_y[10][400] =   {{5600},
@@ -685,101 +864,41 @@ int SPIRALE(void)
     TRISB = 0x0000;                         // PORTB auf schreiben stellen
     TRISE = 0x00cc;
    
-    for(k=0;k < 10;k++)
+    FORTSCHRITT_BEGINNEN(MUSTER_SPIRALE, &k_Start, &i_Start, &j_Start);
+    Delay_Anfang = ECKE_DELAY(0, 0, 0, 0, Delay_max);      // aus dem Stillstand, auch beim Fortsetzen
+    for(k=k_Start;k < 10;k++)
     {
-        for(i=0;i < x[k];i++)
+        for(i=i_Start;i < x[k];i++)
         {
-            ///////////////////////////////////////////////////////Bestimmung der Richtung
-            if(x_richtung[k]< 0)
-            {
-                X_DIR = 0x00;
-                Positionsanfahrt_x = (-1)*x_richtung[k];
-            }
-            else
-            {
-                X_DIR = 0x08;
-                Positionsanfahrt_x = x_richtung[k];
-            }
-            if(Positionsanfahrt_y[k][i] < 0)
-            {
-                Y_DIR = 0x00; 
-                Positionsanfahrt_y[k][i] = (-1)*Positionsanfahrt_y[k][i];
-            }
-            else
+            if(i+1 < x[k])                         // nchstes Teilstck
             {
-                Y_DIR = 0x04;
+                Nach_x = x_richtung[k];
+                Nach_y = Positionsanfahrt_y[k][i+1];
             }
-            //////////////////////////////////////////////Bestimmung der Wiederholungszahl
-            if(Positionsanfahrt_y[k][i] >= Positionsanfahrt_x)
+            else if(k+1 < 10)
             {
-                X_Schleife = 0;
-                Y_Schleife = Positionsanfahrt_y[k][i] - Positionsanfahrt_x;
-                if(Y_Schleife > Positionsanfahrt_x)
-                {
-                    Y_Schleife = Positionsanfahrt_x;
-                }
-                Schleife = Positionsanfahrt_y[k][i] - Y_Schleife;
+                Nach_x = x_richtung[k+1];
+                Nach_y = Positionsanfahrt_y[k+1][0];
             }
             else
             {
-                Y_Schleife = 0;
-                X_Schleife = Positionsanfahrt_x - Positionsanfahrt_y[k][i];
-                if(X_Schleife > Positionsanfahrt_x/2)
-                {
-                    X_Schleife = Positionsanfahrt_x/2;
-                    Schleife = Positionsanfahrt_x/2;
-                }
-                else
-                {
-                    Schleife = Positionsanfahrt_y[k][i];
-                }
+                Nach_x = 0;
+                Nach_y = 0;
             }
-        
-            for(j=0;j<Schleife;j++)
-            {
-                if(j<Positionsanfahrt_x)
-                {
-                    X_PUL = 0x40;
-                }
-                else
-                {
-                    X_PUL = 0x00;
-                }
-            
-                if(j<Positionsanfahrt_y[k][i])
-                {
-                    Y_PUL = 0x10;
-                }
-                else
-                {
-                    Y_PUL = 0x00;
-                }
-            
-                if(j < X_Schleife)
-                {
-                    X_Schnell = 1;
-                }
-                else
-                {
-                    X_Schnell = 0;
-                }
+            Delay_Ende = ECKE_DELAY(x_richtung[k], Positionsanfahrt_y[k][i], Nach_x, Nach_y, Delay_max);
             
-                if(j < Y_Schleife)
-                {
-                    Y_Schnell = 1;
-                }
-                else
-                {
-                    Y_Schnell = 0;
-                }
-                if((((PORTE) & 0x40) == 0x40) || (((PORTE) & 0x80) == 0x80) || (((PORTE) & 0x08) == 0x08) || (((PORTE) & 0x04) == 0x04) || ((PORTD & 0x20) == 0x20))              // Taste Maskieren
-                {                                           // Stop Bedingung
-                    return 0;
-                }
-                FAHREN(Delay, LED, X_DIR, X_PUL, Y_DIR, Y_PUL, X_Schnell, Y_Schnell);
+            Fortschritt.k = k;
+            Fortschritt.i = i;
+            if(SEGMENT_FAHREN(x_richtung[k], Positionsanfahrt_y[k][i], DELAY_MOTOR, Delay_Anfang, Delay_Ende, LED, j_Start) == 1)
+            {
+                return 0;                           // Abbruch, Sicherung bleibt erhalten
             }
-        } 
+            j_Start = 0;
+            Delay_Anfang = Delay_Ende;              // gleiche Ecke, nicht neu rechnen
+        }
+        i_Start = 0;
     }
+    SICHERUNG_LOESCHEN();
     return 0;
 }
 
@@ -791,51 +910,60 @@ int QUADRATISCHE_SPIRALE(void)
     TRISB = 0x0000;                         // PORTB auf schreiben stellen
     TRISE = 0x00cc;                         // Sensoren
     
-    char X_PUL, X_DIR, Y_PUL, Y_DIR;
     char LED = 0x30; 
     
-    int i,j;
-    int Delay = 200;
+    int i;
+    int i_Start = 0, i_Leer = 0, j_Start = 0;      // i_Leer: nur ein Wert je Teilstck
+    int Delay_Anfang, Delay_Ende, Delay_max = 200;     // Delay_max: engste Stelle
+    int Teil_x[21], Teil_y[21];             // Teilstcke als delta X / delta Y
     // x-richtung = 1; y-richtung = 0;
     int xy_richtung[21] = {1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1}; 
     // vorwaerts = 1; rueckwearts = 0;
     int richtung[21] = {1,1,0,0,1,1,0,0,1,1,0,0,1,1,0,0,1,1,0,0,1};
-    unsigned int X_Schnell=0, Y_Schnell=0;
     unsigned int Positionsanfahrt[21] = {11200,11200,11200,10080,10080,8960,8960,7840,7840,6720,6720,5600,5600,4480,4480,3360,3360,2240,2240,1120,1120};
     
-    
     for(i=0;i<21;i++)
     {
+        Teil_x[i] = 0;
+        Teil_y[i] = 0;
         if(xy_richtung[i]== 1)
         {
-            X_PUL = 0x40;
-            Y_PUL = 0x00;
+            Teil_x[i] = Positionsanfahrt[i];
         }
         else
         {
-            X_PUL = 0x00;
-            Y_PUL = 0x10;
+            Teil_y[i] = Positionsanfahrt[i];
         }
-        if(richtung[i] == 1)
+        if(richtung[i] == 0)
         {
-            X_DIR = 0x08;
-            Y_DIR = 0x04;
+            Teil_x[i] = (-1)*Teil_x[i];
+            Teil_y[i] = (-1)*Teil_y[i];
+        }
+    }
+    
+    FORTSCHRITT_BEGINNEN(MUSTER_QUADRATISCH, &i_Start, &i_Leer, &j_Start);
+    Delay_Anfang = ECKE_DELAY(0, 0, 0, 0, Delay_max);      // aus dem Stillstand, auch beim Fortsetzen
+    for(i=i_Start;i<21;i++)
+    {
+        if(i < 20)
+        {
+            Delay_Ende = ECKE_DELAY(Teil_x[i], Teil_y[i], Teil_x[i+1], Teil_y[i+1], Delay_max);
         }
         else
         {
-            X_DIR = 0x00;
-            Y_DIR = 0x00;
+            Delay_Ende = ECKE_DELAY(Teil_x[i], Teil_y[i], 0, 0, Delay_max);   // letztes Teilstck: Stillstand
         }
         
-        for(j=0; j < Positionsanfahrt[i];j++) 
+        Fortschritt.k = i;
+        Fortschritt.i = 0;
+        if(SEGMENT_FAHREN(Teil_x[i], Teil_y[i], DELAY_MOTOR, Delay_Anfang, Delay_Ende, LED, j_Start) == 1)
         {
-            if((((PORTE) & 0x40) == 0x40) || (((PORTE) & 0x80) == 0x80) || (((PORTE) & 0x08) == 0x08) || (((PORTE) & 0x04) == 0x04) || ((PORTD & 0x20) == 0x20))              // Taste Maskieren
-            {                                           // Stop Bedingung
-                return 0;
-            }
-            FAHREN(Delay, LED, X_DIR, X_PUL, Y_DIR, Y_PUL, X_Schnell, Y_Schnell);
+            return 0;                           // Abbruch, Sicherung bleibt erhalten
         }
+        j_Start = 0;
+        Delay_Anfang = Delay_Ende;
     }
+    SICHERUNG_LOESCHEN();
     return 0;
 }
 
@@ -845,12 +973,1724 @@ void ABSCHALTEN(void)
     TRISB = 0x0000;                         // PORTB auf schreiben stellen
     PORTB = 0x0000;                         // ENA = 0; DIR = 0;
     PORTG = 0x0000;                         // PUL = 0;
-    T1CON = 0x8030;                         // Einstellung Timer 1
+    Stopp_gesperrt = 1;                     // Stopp erst wieder nach dem Loslassen
+    Letzte_Phase = 0;
+    Letzter_Anteil_X = 0;
+    Letzter_Anteil_Y = 0;
+    
+    SICHERUNG_VORBEREITEN();                // Motoren stehen: Flash lschen
+    WARTEN_MS(1000);
+}
+
+/******************************************************************************\
+ * SEGMENT_FAHREN fhrt ein Teilstck (delta X, delta Y) wie oben beschrieben *
+ * ab. Mit j_Start wird mitten im Teilstck begonnen (Fortsetzen nach einem   *
+ * Abbruch). Delay_Anfang/Delay_Ende sind die Delays an den Ecken (ECKE_DELAY),*
+ * sie gelten fr den ersten (auch j_Start) bzw. letzten Schritt und gehen    *
+ * ber ECKE_SCHRITTE linear in Delay ber (kleiner als Delay: keine Rampe).  *
+ * Gerechnet wird je Phase (siehe oben). Ist das vorige Teilstck zu          *
+ * kurz, um bis auf seine Eck-Delay zu beschleunigen, beginnt dieses bei der  *
+ * Delay, mit der es aufgehrt hat (Letzte_Phase). Zuletzt begrenzt           *
+ * SPRUNG_BEGRENZEN jede Phase gegenber dem vorigen Durchlauf.               *
+ * Rckgabe: 1 = abgebrochen (Sensor oder Stopp-Taste), sonst 0.              *
+\******************************************************************************/
+int SEGMENT_FAHREN(int Delta_x, int Delta_y, int Delay, int Delay_Anfang, int Delay_Ende, char LED, int j_Start)
+{
+    char X_PUL,X_DIR,Y_PUL,Y_DIR;
+    int j, Rest, Delay_j, Delay_Rampe, Anteil_x, Anteil_y;
+    int Schleife, X_Schleife=0, Y_Schleife=0, X_Schnell=0, Y_Schnell=0;
+    int Positionsanfahrt_x;  // Betrag von delta X
+    int Positionsanfahrt_y;  // Betrag von delta Y
     
-    TMR1 = 0;                               // Reset Timer 1
-    while (TMR1 < 15625)
+    ///////////////////////////////////////////////////////Bestimmung der Richtung
+    if(Delta_x < 0)
     {
-        //warten
+        X_DIR = 0x00;
+        Positionsanfahrt_x = (-1)*Delta_x;
+    }
+    else
+    {
+        X_DIR = 0x08;
+        Positionsanfahrt_x = Delta_x;
+    }
+    if(Delta_y < 0)
+    {
+        Y_DIR = 0x00; 
+        Positionsanfahrt_y = (-1)*Delta_y;
+    }
+    else
+    {
+        Y_DIR = 0x04;
+        Positionsanfahrt_y = Delta_y;
+    }
+    Schleife = SCHLEIFE_BERECHNEN(Positionsanfahrt_x, Positionsanfahrt_y, &X_Schleife, &Y_Schleife);
+    Delay = DELAY_BEGRENZEN(Delay, X_Schleife, Y_Schleife);
+    if((X_Schleife > 0) || (Y_Schleife > 0))
+    {
+        Delay = Delay/2;                    // je Phase, schnelle Achse bleibt gleich schnell
+    }
+    if(Letzte_Phase > Delay_Anfang)         // voriges Teilstck kam nicht bis auf seine Eck-Delay
+    {
+        Delay_Anfang = Letzte_Phase;
+    }
+
+    for(j=j_Start;j<Schleife;j++)
+    {
+        if(j<Positionsanfahrt_x)
+        {
+            X_PUL = 0x40;
+        }
+        else
+        {
+            X_PUL = 0x00;
+        }
+    
+        if(j<Positionsanfahrt_y)
+        {
+            Y_PUL = 0x10;
+        }
+        else
+        {
+            Y_PUL = 0x00;
+        }
+    
+        if(j < X_Schleife)
+        {
+            X_Schnell = 1;
+        }
+        else
+        {
+            X_Schnell = 0;
+        }
+    
+        if(j < Y_Schleife)
+        {
+            Y_Schnell = 1;
+        }
+        else
+        {
+            Y_Schnell = 0;
+        }
+        if((((PORTE) & 0x40) == 0x40) || (((PORTE) & 0x80) == 0x80) || (((PORTE) & 0x08) == 0x08) || (((PORTE) & 0x04) == 0x04) || ((PORTD & 0x20) == 0x20))              // Taste Maskieren
+        {                                           // Stop Bedingung
+            return 1;
+        }
+        Fortschritt.j = j;
+        SICHERUNG_PRUEFEN();                        // Stand vor dem Schritt j sichern
+        
+        Delay_j = Delay;                            // je Phase
+        if((j - j_Start < ECKE_SCHRITTE) && (Delay_Anfang > Delay))    // nach der Ecke beschleunigen
+        {
+            Delay_j = Delay_Anfang - (int)((unsigned long)(Delay_Anfang - Delay)*(j - j_Start)/ECKE_SCHRITTE);
+        }
+        Rest = Schleife - 1 - j;
+        if((Rest < ECKE_SCHRITTE) && (Delay_Ende > Delay))             // vor der Ecke bremsen
+        {
+            Delay_Rampe = Delay_Ende - (int)((unsigned long)(Delay_Ende - Delay)*Rest/ECKE_SCHRITTE);
+            if(Delay_Rampe > Delay_j)
+            {
+                Delay_j = Delay_Rampe;
+            }
+        }
+        Anteil_x = 0;                               // Betrag wie ECKE_ANTEIL
+        Anteil_y = 0;
+        if(X_PUL != 0)
+        {
+            Anteil_x = 2 - Y_Schnell;
+        }
+        if(Y_PUL != 0)
+        {
+            Anteil_y = 2 - X_Schnell;
+        }
+        Delay_j = SPRUNG_BEGRENZEN(Delay_j, Anteil_x, Anteil_y);
+        if((X_Schnell == 1) || (Y_Schnell == 1))    // vier Phasen statt zwei
+        {
+            Delay_j = 2*Delay_j;
+        }
+        FAHREN(Delay_j, LED, X_DIR, X_PUL, Y_DIR, Y_PUL, X_Schnell, Y_Schnell);
+    }
+    return 0;
+}
+
+/******************************************************************************\
+ * SCHLEIFE_BERECHNEN bestimmt fr die Betrge von delta X und delta Y die    *
+ * Anzahl der FAHREN-Aufrufe und wie viele davon X_Schnell bzw. Y_Schnell     *
+ * brauchen (siehe Beschreibung oben).                                        *
+\******************************************************************************/
+int SCHLEIFE_BERECHNEN(int Positionsanfahrt_x, int Positionsanfahrt_y, int *X_Schleife, int *Y_Schleife)
+{
+    int Schleife;
+    
+    //////////////////////////////////////////////Bestimmung der Wiederholungszahl
+    if(Positionsanfahrt_y >= Positionsanfahrt_x)
+    {
+        *X_Schleife = 0;
+        *Y_Schleife = Positionsanfahrt_y - Positionsanfahrt_x;
+        if(*Y_Schleife > Positionsanfahrt_y/2)
+        {
+            *Y_Schleife = Positionsanfahrt_y/2;
+            Schleife = Positionsanfahrt_y - *Y_Schleife; // ungerades delta Y: ein einfacher Schritt mehr
+        }
+        else
+        {
+            Schleife = Positionsanfahrt_x;
+        }
+    }
+    else
+    {
+        *Y_Schleife = 0;
+        *X_Schleife = Positionsanfahrt_x - Positionsanfahrt_y;
+        if(*X_Schleife > Positionsanfahrt_x/2)
+        {
+            *X_Schleife = Positionsanfahrt_x/2;
+            Schleife = Positionsanfahrt_x - *X_Schleife; // ungerades delta X: ein einfacher Schritt mehr
+        }
+        else
+        {
+            Schleife = Positionsanfahrt_y;
+        }
+    }
+    return Schleife;
+}
+
+int DELAY_BEGRENZEN(int Delay, int X_Schleife, int Y_Schleife) // Motorgrenze einhalten
+{
+    if((X_Schleife > 0) || (Y_Schleife > 0))    // schnelle Achse kommt einmal pro Delay
+    {
+        if(Delay < 2*DELAY_MOTOR)
+        {
+            Delay = 2*DELAY_MOTOR;
+        }
+    }
+    else if(Delay < DELAY_MOTOR)
+    {
+        Delay = DELAY_MOTOR;
+    }
+    return Delay;
+}
+
+/******************************************************************************\
+ * ECKE_DELAY bestimmt die Delay an der Ecke von Teilstck A nach B allein    *
+ * aus dem Knickwinkel. Mit q = |A x B| / (|A x B| + A*B) (0 = gerade weiter, *
+ * 1/2 bei 45, 1 bei 90) wird zwischen DELAY_MOTOR und Delay_max geteilt,   *
+ * ab 90 gilt Delay_max. Nur ganze Zahlen, keine Wurzel. Ist A oder B 0      *
+ * (Anfang bzw. Ende des Musters), ist das Stillstand und gilt Delay_max.     *
+ * Danach wird die Delay so weit angehoben, dass keine Achse zwischen dem     *
+ * letzten Durchlauf von A und dem ersten von B strker springt als aus dem   *
+ * Stillstand mit DELAY_STILLSTAND (siehe ECKE_ANTEIL).                       *
+\******************************************************************************/
+int ECKE_DELAY(int A_x, int A_y, int B_x, int B_y, int Delay_max)
+{
+    long Kreuz, Skalar;
+    int Delay, Sprung, A_Anteil_x, A_Anteil_y, B_Anteil_x, B_Anteil_y;
+    
+    Kreuz = (long)A_x*B_y - (long)A_y*B_x;
+    Skalar = (long)A_x*B_x + (long)A_y*B_y;
+    if(Kreuz < 0)
+    {
+        Kreuz = (-1)*Kreuz;
+    }
+    if(Delay_max <= DELAY_MOTOR)
+    {
+        Delay = DELAY_MOTOR;
+    }
+    else if(((A_x == 0) && (A_y == 0)) || ((B_x == 0) && (B_y == 0)))
+    {
+        Delay = Delay_max;                      // aus dem bzw. in den Stillstand
+    }
+    else if(Skalar <= 0)
+    {
+        Delay = Delay_max;                      // 90 und mehr
+    }
+    else
+    {
+        while(Kreuz + Skalar >= 0x00100000L)    // Produkt unten muss in long passen
+        {
+            Kreuz = Kreuz >> 1;
+            Skalar = Skalar >> 1;
+        }
+        Delay = DELAY_MOTOR + (int)(Kreuz*(Delay_max - DELAY_MOTOR)/(Kreuz + Skalar));
+    }
+    
+    ECKE_ANTEIL(A_x, A_y, 1, &A_Anteil_x, &A_Anteil_y);
+    ECKE_ANTEIL(B_x, B_y, 0, &B_Anteil_x, &B_Anteil_y);
+    Sprung = A_Anteil_x - B_Anteil_x;
+    if(Sprung < 0)
+    {
+        Sprung = (-1)*Sprung;
+    }
+    if(A_Anteil_y - B_Anteil_y > Sprung)
+    {
+        Sprung = A_Anteil_y - B_Anteil_y;
+    }
+    if(B_Anteil_y - A_Anteil_y > Sprung)
+    {
+        Sprung = B_Anteil_y - A_Anteil_y;
+    }
+    if(Delay < Sprung*(DELAY_STILLSTAND/2))     // Sprung 2 = aus dem Stillstand
+    {
+        Delay = Sprung*(DELAY_STILLSTAND/2);
+    }
+    return Delay;
+}
+
+/******************************************************************************\
+ * ECKE_ANTEIL gibt fr den ersten (Ende = 0) bzw. letzten (Ende = 1)         *
+ * Durchlauf eines Teilstcks an, wie viele halbe Schritte jede Achse je      *
+ * 2*Eck-Delay macht, mit Vorzeichen: 2 in normalen Durchlufen, in Schnell-  *
+ * Durchlufen (doppelte Eck-Delay) 2 fr die schnelle und 1 fr die andere   *
+ * Achse, 0 wenn die Achse in diesem Durchlauf keinen Schritt macht. Macht    *
+ * sie im ersten nur einen und steht danach, zhlt auch das als 0: dieser     *
+ * Schritt kommt noch im Abstand des vorigen Teilstcks, danach hlt sie an.  *
+\******************************************************************************/
+void ECKE_ANTEIL(int Delta_x, int Delta_y, int Ende, int *Anteil_x, int *Anteil_y)
+{
+    int j, Schleife, X_Schleife, Y_Schleife;
+    int Positionsanfahrt_x = Delta_x;       // Betrag von delta X
+    int Positionsanfahrt_y = Delta_y;       // Betrag von delta Y
+    
+    if(Positionsanfahrt_x < 0)
+    {
+        Positionsanfahrt_x = (-1)*Positionsanfahrt_x;
+    }
+    if(Positionsanfahrt_y < 0)
+    {
+        Positionsanfahrt_y = (-1)*Positionsanfahrt_y;
+    }
+    Schleife = SCHLEIFE_BERECHNEN(Positionsanfahrt_x, Positionsanfahrt_y, &X_Schleife, &Y_Schleife);
+    j = 0;
+    if(Ende == 1)
+    {
+        j = Schleife - 1;
+    }
+    *Anteil_x = 0;
+    *Anteil_y = 0;
+    if(Schleife == 0)                       // Stillstand
+    {
+        return;
+    }
+    if((j < Positionsanfahrt_x) && ((j + 1 == Schleife) || (j + 1 < Positionsanfahrt_x)))
+    {
+        *Anteil_x = 2;
+    }
+    if((j < Positionsanfahrt_y) && ((j + 1 == Schleife) || (j + 1 < Positionsanfahrt_y)))
+    {
+        *Anteil_y = 2;
+    }
+    if(j < X_Schleife)
+    {
+        *Anteil_y = *Anteil_y/2;
+    }
+    if(j < Y_Schleife)
+    {
+        *Anteil_x = *Anteil_x/2;
+    }
+    if(Delta_x < 0)
+    {
+        *Anteil_x = (-1)*(*Anteil_x);
+    }
+    if(Delta_y < 0)
+    {
+        *Anteil_y = (-1)*(*Anteil_y);
+    }
+}
+
+/******************************************************************************\
+ * SPRUNG_BEGRENZEN begrenzt die Phase Delay des nchsten Durchlaufs mit den  *
+ * Anteilen Anteil_x/Anteil_y (Betrag wie ECKE_ANTEIL) so, dass keine Achse   *
+ * ihre Geschwindigkeit gegenber dem letzten FAHREN (Letzte_Phase,           *
+ * Letzter_Anteil) strker ndert als beim Anfahren aus dem Stillstand mit    *
+ * DELAY_STILLSTAND. Eckrampen und ECKE_DELAY bleiben meist darunter, die     *
+ * Grenze greift, wenn ein kurzes Teilstck nicht genug Durchlufe fr seine  *
+ * Rampen hat. Dann wird langsamer gebremst und die Ecke etwas schneller      *
+ * durchfahren, Anfahren geht vor. Umkehren deckt ECKE_DELAY ab.              *
+\******************************************************************************/
+int SPRUNG_BEGRENZEN(int Delay, int Anteil_x, int Anteil_y)
+{
+    long Unten = 0;
+    long Oben = Delay;
+    
+    SPRUNG_GRENZEN(Letzter_Anteil_X, Anteil_x, &Unten, &Oben);
+    SPRUNG_GRENZEN(Letzter_Anteil_Y, Anteil_y, &Unten, &Oben);
+    if(Delay > Oben)
+    {
+        Delay = (int)Oben;                  // nicht so stark bremsen
+    }
+    if(Delay < Unten)
+    {
+        Delay = (int)Unten;                 // nicht so stark beschleunigen
+    }
+    return Delay;
+}
+
+/******************************************************************************\
+ * SPRUNG_GRENZEN engt fr eine Achse mit dem Anteil Alt im letzten und Neu   *
+ * im nchsten Durchlauf die Phase ein. Geschwindigkeit ist Anteil/Phase, der *
+ * Sprung darf hchstens 1/(DELAY_STILLSTAND/2) sein (Anteil 2 aus dem        *
+ * Stillstand mit DELAY_STILLSTAND). Letzte_Phase 0 ist Stillstand. Mit       *
+ * Neu = 0 gibt es nichts zu whlen.                                          *
+\******************************************************************************/
+void SPRUNG_GRENZEN(int Alt, int Neu, long *Unten, long *Oben)
+{
+    long Phase = Letzte_Phase;
+    long Grenze = DELAY_STILLSTAND/2;
+    long Nenner, Wert;
+    
+    if(Neu == 0)
+    {
+        return;
+    }
+    if(Phase == 0)
+    {
+        Alt = 0;                            // aus dem Stillstand
+        Phase = 1;
+    }
+    Nenner = Alt*Grenze + Phase;            // schnellstens Alt/Phase + 1/Grenze
+    Wert = (Neu*Grenze*Phase + Nenner - 1)/Nenner;
+    if(Wert > *Unten)
+    {
+        *Unten = Wert;
+    }
+    Nenner = Alt*Grenze - Phase;            // langsamstens Alt/Phase - 1/Grenze
+    if(Nenner > 0)
+    {
+        Wert = Neu*Grenze*Phase/Nenner;
+        if(Wert < *Oben)
+        {
+            *Oben = Wert;
+        }
+    }
+}
+
+/******************************************************************************\
+ * ANFAHREN fhrt erst in x- und dann in y-Richtung auf eine absolute         *
+ * Position. Rckgabe: 1 = abgebrochen, sonst 0.                              *
+\******************************************************************************/
+int ANFAHREN(int Ziel_x, int Ziel_y)
+{
+    int Delay = 300;
+    char X_DIR, Y_DIR;
+    char LED = 0x00;
+    
+    while(Position_X != Ziel_x)
+    {
+        if((((PORTE) & 0x40) == 0x40) || (((PORTE) & 0x80) == 0x80) || (((PORTE) & 0x08) == 0x08) || (((PORTE) & 0x04) == 0x04) || ((PORTD & 0x20) == 0x20))              // Taste Maskieren
+        {                                           // Stop Bedingung
+            return 1;
+        }
+        if(Position_X < Ziel_x)
+        {
+            X_DIR = 0x08;
+        }
+        else
+        {
+            X_DIR = 0x00;
+        }
+        FAHREN(Delay, LED, X_DIR, 0x40, 0x00, 0x00, 0, 0);
+    }
+    while(Position_Y != Ziel_y)
+    {
+        if((((PORTE) & 0x40) == 0x40) || (((PORTE) & 0x80) == 0x80) || (((PORTE) & 0x08) == 0x08) || (((PORTE) & 0x04) == 0x04) || ((PORTD & 0x20) == 0x20))              // Taste Maskieren
+        {                                           // Stop Bedingung
+            return 1;
+        }
+        if(Position_Y < Ziel_y)
+        {
+            Y_DIR = 0x04;
+        }
+        else
+        {
+            Y_DIR = 0x00;
+        }
+        FAHREN(Delay, LED, 0x00, 0x00, Y_DIR, 0x10, 0, 0);
+    }
+    return 0;
+}
+
+/******************************************************************************\
+ * FORTSETZEN_ANBIETEN wird nach dem Referenzieren aufgerufen. Liegt eine     *
+ * Sicherung eines abgebrochenen Musters vor, leuchten alle LEDs:             *
+ * Reset-Taste (RD4) = an die gesicherte Position fahren und fortsetzen,      *
+ * Stopp-Taste (RD5) = Sicherung verwerfen.                                   *
+\******************************************************************************/
+int FORTSETZEN_ANBIETEN(void)
+{
+    SICHERUNG Gesichert;
+    
+    if(SICHERUNG_LESEN(&Gesichert) == 0)
+    {
+        return 0;
+    }
+    
+    TRISA = 0x0000;                         // PORTA auf schreiben stellen
+    PORTA = 0x00FF;                         // alle LED's an
+    while((PORTD & 0x10) == 0x10)           // Reset-Taste erst loslassen
+    {
+        //warten
+    }
+    while(1)
+    {
+        if(TASTE(0x10) == 1)                // Reset-Taste   RD4, entprellt
+        {
+            break;
+        }
+        if(TASTE(0x20) == 1)                // Stopp-Taste   RD5, entprellt
+        {
+            PORTA = 0x0000;
+            SICHERUNG_LOESCHEN();
+            return 0;
+        }
+    }
+    PORTA = 0x0000;
+    
+    Fortschritt.Muster = MUSTER_KEINS;      // Anfahrt wird nicht gesichert
+    if(ANFAHREN(Gesichert.X, Gesichert.Y) == 1)
+    {
+        return 0;
+    }
+    
+    Fortsetzung = Gesichert;
+    switch(Gesichert.Muster)
+    {
+        case MUSTER_HSKA_LOGO:      HsKa_Logo();
+                                    break;
+        
+        case MUSTER_SPIRALE:        SPIRALE();
+                                    break;
+        
+        case MUSTER_QUADRATISCH:    QUADRATISCHE_SPIRALE();
+                                    break;
+        
+        case MUSTER_RADIEREN:       Radieren();
+                                    break;
+        
+        case MUSTER_EXTERN:         MUSTER_EXTERN_FAHREN(Gesichert.k);
+                                    break;
+        
+        default:                    break;
+    }
+    Fortsetzung.Muster = MUSTER_KEINS;
+    return 1;
+}
+
+void FORTSCHRITT_BEGINNEN(int Muster, int *k_Start, int *i_Start, int *j_Start)
+{
+    Fortschritt.Muster = Muster;
+    Sicherung_Termin = ZEIT();              // erster Schritt wird gleich gesichert
+    
+    if(Fortsetzung.Muster == Muster)
+    {
+        *k_Start = Fortsetzung.k;
+        *i_Start = Fortsetzung.i;
+        *j_Start = Fortsetzung.j;
+    }
+    Fortsetzung.Muster = MUSTER_KEINS;
+}
+
+void SICHERUNG_PRUEFEN(void)
+{
+    unsigned long Jetzt;
+    
+    if((Fortschritt.Muster == MUSTER_KEINS) || (Referenziert == 0))
+    {
+        return;                             // ohne Referenz nicht fortsetzbar
+    }
+    
+    Jetzt = ZEIT();
+    if(((long)(Jetzt - Sicherung_Termin) >= 0) && (Sicherung_Wort >= SICHERUNG_WORTE))
+    {
+        Sicherung_Termin = Jetzt + SICHERUNG_INTERVALL;
+        Fortschritt.X = Position_X;
+        Fortschritt.Y = Position_Y;
+        SICHERUNG_BEGINNEN(&Fortschritt);   // Worte schreibt WARTEN_BIS
+    }
+}
+
+void SICHERUNG_LOESCHEN(void)               // Muster beendet oder verworfen
+{
+    SICHERUNG Leer = {MUSTER_KEINS};
+    
+    Fortschritt.Muster = MUSTER_KEINS;
+    if(SICHERUNG_BEGINNEN(&Leer) == 0)      // kein Platz: Muster ist zu Ende, hier darf gelscht werden
+    {
+        SICHERUNG_VORBEREITEN();
+        SICHERUNG_BEGINNEN(&Leer);
+    }
+    SICHERUNG_ABSCHLIESSEN();
+}
+
+/******************************************************************************\
+ * SICHERUNG_LESEN sucht den Eintrag mit der hchsten Laufnummer und merkt    *
+ * sich den nchsten freien Platz. Rckgabe: 1 = abgebrochenes Muster liegt   *
+ * vor, 0 = keine Sicherung oder Muster wurde beendet.                        *
+\******************************************************************************/
+int SICHERUNG_LESEN(SICHERUNG *Ziel)
+{
+    int n, Neuester = -1;
+    unsigned int Basis, Laufnummer = 0;
+    
+    for(n=0;n < SICHERUNG_EINTRAEGE;n++)
+    {
+        Basis = n*SICHERUNG_WORTE;
+        if(FLASH_WORT_LESEN(Basis + 7) != SICHERUNG_KENNUNG)
+        {
+            continue;
+        }
+        if((Neuester < 0) || ((short)(FLASH_WORT_LESEN(Basis + 6) - Laufnummer) > 0))
+        {
+            Neuester = n;
+            Laufnummer = FLASH_WORT_LESEN(Basis + 6);
+        }
+    }
+    
+    Sicherung_Platz = Neuester + 1;
+    Sicherung_Laufnummer = Laufnummer + 1;
+    if(Neuester < 0)
+    {
+        return 0;
+    }
+    
+    Basis = Neuester*SICHERUNG_WORTE;
+    Ziel->Muster = FLASH_WORT_LESEN(Basis + 0);
+    Ziel->k      = FLASH_WORT_LESEN(Basis + 1);
+    Ziel->i      = FLASH_WORT_LESEN(Basis + 2);
+    Ziel->j      = FLASH_WORT_LESEN(Basis + 3);
+    Ziel->X      = (short)FLASH_WORT_LESEN(Basis + 4);    // (short): auch mit 32-Bit-int (tools/)
+    Ziel->Y      = (short)FLASH_WORT_LESEN(Basis + 5);
+    if(Ziel->Muster == MUSTER_KEINS)
+    {
+        return 0;
+    }
+    return 1;
+}
+
+/******************************************************************************\
+ * SICHERUNG_BEGINNEN sucht den nchsten freien Platz und legt den Eintrag    *
+ * zum Schreiben bereit (SICHERUNG_WEITER). Gelscht wird hier nie.           *
+ * Rckgabe: 1 = Eintrag begonnen, 0 = kein freier Platz.                     *
+\******************************************************************************/
+int SICHERUNG_BEGINNEN(SICHERUNG *Quelle)
+{
+    SICHERUNG Alt;
+    int n;
+    
+    SICHERUNG_ABSCHLIESSEN();               // vorigen Eintrag erst fertig schreiben
+    if(Sicherung_Platz < 0)                 // erster Aufruf nach dem Einschalten
+    {
+        SICHERUNG_LESEN(&Alt);
+    }
+    
+    ///////////////////////////////////////////////////////Freien Platz suchen
+    for(n=0;n < SICHERUNG_PRO_PAGE;n++)
+    {
+        if(Sicherung_Platz >= SICHERUNG_EINTRAEGE)
+        {
+            Sicherung_Platz = 0;
+        }
+        if(FLASH_WORT_LESEN(Sicherung_Platz*SICHERUNG_WORTE) == 0xFFFF)
+        {
+            break;
+        }
+        Sicherung_Platz++;                  // belegt oder halb geschrieben: berspringen
+    }
+    if(n == SICHERUNG_PRO_PAGE)
+    {
+        return 0;                           // Page nicht gelscht
+    }
+    
+    Sicherung_Basis = Sicherung_Platz*SICHERUNG_WORTE;
+    Sicherung_Daten[0] = Quelle->Muster;
+    Sicherung_Daten[1] = Quelle->k;
+    Sicherung_Daten[2] = Quelle->i;
+    Sicherung_Daten[3] = Quelle->j;
+    Sicherung_Daten[4] = Quelle->X;
+    Sicherung_Daten[5] = Quelle->Y;
+    Sicherung_Daten[6] = Sicherung_Laufnummer;
+    Sicherung_Daten[7] = SICHERUNG_KENNUNG; // zuletzt: Eintrag gltig
+    Sicherung_Wort = 0;
+    
+    Sicherung_Platz++;
+    Sicherung_Laufnummer++;
+    return 1;
+}
+
+void SICHERUNG_WEITER(void)                 // nchstes Wort des Eintrags schreiben
+{
+    if(Sicherung_Wort < SICHERUNG_WORTE)
+    {
+        FLASH_WORT_SCHREIBEN(Sicherung_Basis + Sicherung_Wort, Sicherung_Daten[Sicherung_Wort]);
+        Sicherung_Wort++;
+    }
+}
+
+void SICHERUNG_ABSCHLIESSEN(void)           // angefangenen Eintrag fertig schreiben
+{
+    while(Sicherung_Wort < SICHERUNG_WORTE)
+    {
+        SICHERUNG_WEITER();
+    }
+}
+
+/******************************************************************************\
+ * SICHERUNG_VORBEREITEN wird bei stehenden Motoren aufgerufen. Alle Pages    *
+ * auer der mit dem zuletzt geschriebenen Eintrag werden gelscht, sofern    *
+ * sie nicht schon leer sind (20 ms je Page).                                 *
+\******************************************************************************/
+void SICHERUNG_VORBEREITEN(void)
+{
+    SICHERUNG Alt;
+    int Page, Aktuell;
+    
+    SICHERUNG_ABSCHLIESSEN();
+    if(Sicherung_Platz < 0)
+    {
+        SICHERUNG_LESEN(&Alt);
+    }
+    Aktuell = ((Sicherung_Platz + SICHERUNG_EINTRAEGE - 1) % SICHERUNG_EINTRAEGE) / SICHERUNG_PRO_PAGE;
+    for(Page=0;Page < SICHERUNG_PAGES;Page++)
+    {
+        if((Page != Aktuell) && (FLASH_PAGE_LEER(Page) == 0))
+        {
+            FLASH_PAGE_LOESCHEN(Page);
+        }
+    }
+}
+
+unsigned int FLASH_WORT_LESEN(unsigned int Index)
+{
+    TBLPAG = __builtin_tblpage(Sicherung_Flash);
+    return __builtin_tblrdl(__builtin_tbloffset(Sicherung_Flash) + 2*Index);
+}
+
+void FLASH_WORT_SCHREIBEN(unsigned int Index, unsigned int Wert)
+{
+    unsigned int Adresse;
+    
+    NVMCON = 0x4003;                        // ein Befehlswort programmieren
+    TBLPAG = __builtin_tblpage(Sicherung_Flash);
+    Adresse = __builtin_tbloffset(Sicherung_Flash) + 2*Index;
+    __builtin_tblwtl(Adresse, Wert);
+    __builtin_tblwth(Adresse, 0xFF);        // oberes Byte bleibt gelscht
+    __builtin_write_NVM();
+    while(NVMCONbits.WR == 1)
+    {
+        //warten
+    }
+}
+
+int FLASH_PAGE_LEER(unsigned int Page)      // 1 = alle Worte gelscht
+{
+    unsigned int n;
+    
+    for(n=0;n < FLASH_PAGE;n++)
+    {
+        if(FLASH_WORT_LESEN(Page*FLASH_PAGE + n) != 0xFFFF)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void FLASH_PAGE_LOESCHEN(unsigned int Page)
+{
+    NVMCON = 0x4042;                        // eine Page lschen
+    TBLPAG = __builtin_tblpage(Sicherung_Flash);
+    __builtin_tblwtl(__builtin_tbloffset(Sicherung_Flash) + 2*Page*FLASH_PAGE, 0x0000);
+    __builtin_write_NVM();
+    while(NVMCONbits.WR == 1)
+    {
+        //warten
+    }
+}
+
+/******************************************************************************\
+ * MUSTER_EXTERN_FAHREN fhrt Muster Nummer aus dem SPI-Flash ab. Fr die     *
+ * Geschwindigkeit wird immer ein Teilstck im Voraus gelesen.                *
+\******************************************************************************/
+int MUSTER_EXTERN_FAHREN(int Nummer)
+{
+    char LED = 0x00;
+    
+    int i, Anzahl;
+    int k_Start = 0, i_Start = 0, j_Start = 0;
+    int Delay, Delay_max = 300, Delay_Anfang, Delay_Ende;
+    int Delta_x, Delta_y, Delay_fest;
+    int Nach_x = 0, Nach_y = 0, Nach_Delay = 0;
+    
+    TRISG = 0x0000;                         // PORTG auf schreiben stellen
+    TRISA = 0x0000;                         // PORTA auf schreiben stellen
+    LATA  = 0x0000;                         // LED's ansteuern
+    TRISB = 0x0000;                         // PORTB auf schreiben stellen
+    TRISE = 0x00cc;                         // Sensoren
+    
+    if((Nummer < 0) || (Nummer >= Extern_Anzahl) || (Extern_Index[Nummer] == 0))
+    {
+        return 0;                           // kein oder gesperrter Eintrag
+    }
+    
+    FORTSCHRITT_BEGINNEN(MUSTER_EXTERN, &k_Start, &i_Start, &j_Start);
+    Anzahl = EXTERN_OEFFNEN(Nummer, i_Start, &LED, &Delay_max);
+    Delay_Anfang = ECKE_DELAY(0, 0, 0, 0, Delay_max);      // aus dem Stillstand, auch beim Fortsetzen
+    if(i_Start < Anzahl)
+    {
+        EXTERN_TEILSTUECK_HOLEN(&Delta_x, &Delta_y, &Delay_fest);
+    }
+    
+    for(i=i_Start;i < Anzahl;i++)
+    {
+        if(i+1 < Anzahl)                        // nchstes Teilstck
+        {
+            EXTERN_TEILSTUECK_HOLEN(&Nach_x, &Nach_y, &Nach_Delay);
+        }
+        else
+        {
+            Nach_x = 0;
+            Nach_y = 0;
+        }
+        Delay_Ende = ECKE_DELAY(Delta_x, Delta_y, Nach_x, Nach_y, Delay_max);
+        
+        Fortschritt.k = Nummer;
+        Fortschritt.i = i;
+        Delay = DELAY_MOTOR;
+        if(Delay_fest != 0)                     // feste Delay, Ecken werden trotzdem gebremst
+        {
+            Delay = Delay_fest;
+        }
+        if(SEGMENT_FAHREN(Delta_x, Delta_y, Delay, Delay_Anfang, Delay_Ende, LED, j_Start) == 1)
+        {
+            EXTERN_SCHLIESSEN();
+            return 0;                           // Abbruch, Sicherung bleibt erhalten
+        }
+        j_Start = 0;
+        Delay_Anfang = Delay_Ende;
+        Delta_x = Nach_x;
+        Delta_y = Nach_y;
+        Delay_fest = Nach_Delay;
+    }
+    EXTERN_SCHLIESSEN();
+    SICHERUNG_LOESCHEN();
+    return 0;
+}
+
+void EXTERN_INIT(void)                      // SPI1 einstellen und Verzeichnis lesen
+{
+    int n;
+    unsigned int Anzahl, Kennung;
+    unsigned long Adresse;
+    
+    TRISF = (TRISF & ~0x0144) | 0x0080;     // SCK1, SDO1, CS schreiben; SDI1 lesen
+    EXTERN_CS = 1;
+    SPI1STAT = 0x0000;
+    SPI1CON1 = 0x013E;                      // Master, Modus 0, 1 MHz (4:1, 1:1)
+    SPI1CON2 = 0x0000;
+    SPI1STAT = 0x8000;                      // SPI1 ein
+    
+    EXTERN_ADRESSE(0);
+    Kennung  = EXTERN_BYTE(0x00);
+    Kennung |= (unsigned int)EXTERN_BYTE(0x00) << 8;
+    Anzahl  = EXTERN_BYTE(0x00);
+    Anzahl |= (unsigned int)EXTERN_BYTE(0x00) << 8;
+    Extern_Anzahl = Anzahl;
+    if((Kennung != EXTERN_KENNUNG) || (Anzahl > EXTERN_MUSTER_MAX))    // leeres Flash liest 0xFFFF
+    {
+        Extern_Anzahl = 0;
+    }
+    for(n=0;n < Extern_Anzahl;n++)
+    {
+        Adresse  = (unsigned long)EXTERN_BYTE(0x00);
+        Adresse |= (unsigned long)EXTERN_BYTE(0x00) << 8;
+        Adresse |= (unsigned long)EXTERN_BYTE(0x00) << 16;
+        Adresse |= (unsigned long)EXTERN_BYTE(0x00) << 24;
+        if((Adresse < EXTERN_VERZEICHNIS + 4UL*Anzahl) || (Adresse > EXTERN_GROESSE - EXTERN_KOPF))
+        {
+            Adresse = 0;                    // zeigt ins Verzeichnis oder hinter das Flash
+        }
+        Extern_Index[n] = Adresse;
+    }
+    EXTERN_CS = 1;
+}
+
+unsigned char EXTERN_BYTE(unsigned char Senden) // ein Byte bertragen (blockierend)
+{
+    SPI1BUF = Senden;
+    while(SPI1STATbits.SPIRBF == 0)
+    {
+        //warten
+    }
+    return SPI1BUF;
+}
+
+void EXTERN_ADRESSE(unsigned long Adresse)  // Lesebefehl ab Adresse
+{
+    EXTERN_CS = 1;
+    EXTERN_CS = 0;
+    EXTERN_BYTE(0x03);                      // READ
+    EXTERN_BYTE((Adresse >> 16) & 0xFF);
+    EXTERN_BYTE((Adresse >> 8) & 0xFF);
+    EXTERN_BYTE(Adresse & 0xFF);
+}
+
+/******************************************************************************\
+ * EXTERN_OEFFNEN liest den Musterkopf und startet das Lesen ab Teilstck     *
+ * i_Start. Die Puffer werden erst mit dem ersten Teilstck gefllt.          *
+ * Rckgabe: Anzahl Teilstcke.                                               *
+\******************************************************************************/
+int EXTERN_OEFFNEN(int Nummer, int i_Start, char *LED, int *Delay_max)
+{
+    unsigned int Anzahl, Wert;
+    
+    EXTERN_ADRESSE(Extern_Index[Nummer]);
+    *LED = EXTERN_BYTE(0x00);
+    EXTERN_BYTE(0x00);
+    Wert  = EXTERN_BYTE(0x00);
+    Wert |= (unsigned int)EXTERN_BYTE(0x00) << 8;
+    if(Wert > EXTERN_DELAY_MAX)
+    {
+        Wert = EXTERN_DELAY_MAX;
+    }
+    if(Wert < DELAY_MOTOR)
+    {
+        Wert = DELAY_MOTOR;
+    }
+    *Delay_max = Wert;
+    Anzahl  = EXTERN_BYTE(0x00);
+    Anzahl |= (unsigned int)EXTERN_BYTE(0x00) << 8;
+    if((Anzahl > 0x7FFF) || ((unsigned long)Anzahl*EXTERN_TEILSTUECK > EXTERN_GROESSE - EXTERN_KOPF - Extern_Index[Nummer]))
+    {
+        Anzahl = 0;                         // Muster reicht ber das Flash hinaus
+    }
+    if(i_Start >= Anzahl)
+    {
+        EXTERN_CS = 1;
+        return Anzahl;
+    }
+    
+    EXTERN_ADRESSE(Extern_Index[Nummer] + EXTERN_KOPF + (unsigned long)i_Start*EXTERN_TEILSTUECK);
+    Extern_Rest = (unsigned long)(Anzahl - i_Start)*EXTERN_TEILSTUECK;
+    Extern_Unterwegs = 0;
+    Extern_Vorne = 0;
+    Extern_Lesen = 0;
+    Extern_Laenge = 0;
+    Extern_Fuellstand = 0;
+    return Anzahl;
+}
+
+void EXTERN_SCHLIESSEN(void)
+{
+    while(Extern_Unterwegs == 1)            // letztes Byte abholen
+    {
+        EXTERN_NACHLADEN();
+    }
+    Extern_Rest = 0;
+    EXTERN_CS = 1;
+}
+
+/******************************************************************************\
+ * EXTERN_NACHLADEN blockiert nie: ein fertiges Byte wird in den hinteren     *
+ * Puffer bernommen und das nchste angefordert.                             *
+\******************************************************************************/
+void EXTERN_NACHLADEN(void)
+{
+    if(Extern_Unterwegs == 1)
+    {
+        if(SPI1STATbits.SPIRBF == 0)
+        {
+            return;                             // Byte noch unterwegs
+        }
+        Extern_Puffer[1 - Extern_Vorne][Extern_Fuellstand] = SPI1BUF;
+        Extern_Fuellstand++;
+        Extern_Rest--;
+        Extern_Unterwegs = 0;
+    }
+    if((Extern_Rest > 0) && (Extern_Fuellstand < EXTERN_PUFFER))
+    {
+        SPI1BUF = 0x00;                         // nchstes Byte anfordern
+        Extern_Unterwegs = 1;
+    }
+}
+
+void EXTERN_TEILSTUECK_HOLEN(int *Delta_x, int *Delta_y, int *Delay)
+{
+    unsigned char *Teil;
+    unsigned int Wert;
+    
+    if(Extern_Lesen >= Extern_Laenge)       // vorderer Puffer leer: Puffer tauschen
+    {
+        if((Extern_Laenge > 0) && (Extern_Rest > 0) && (Extern_Fuellstand < EXTERN_PUFFER))
+        {
+            Statistik.Extern_Warten++;          // Nachladen kam nicht hinterher
+        }
+        while((Extern_Unterwegs == 1) || ((Extern_Rest > 0) && (Extern_Fuellstand < EXTERN_PUFFER)))
+        {
+            EXTERN_NACHLADEN();
+        }
+        Extern_Vorne = 1 - Extern_Vorne;
+        Extern_Laenge = Extern_Fuellstand;
+        Extern_Lesen = 0;
+        Extern_Fuellstand = 0;
+        EXTERN_NACHLADEN();                     // hinteren Puffer weiter fllen
+    }
+    
+    Teil = &Extern_Puffer[Extern_Vorne][Extern_Lesen];
+    *Delta_x = (short)(Teil[0] | ((unsigned int)Teil[1] << 8));    // (short): auch mit 32-Bit-int (tools/)
+    *Delta_y = (short)(Teil[2] | ((unsigned int)Teil[3] << 8));
+    if(*Delta_x < -32767)                   // Betrag muss in int passen
+    {
+        *Delta_x = -32767;
+    }
+    if(*Delta_y < -32767)
+    {
+        *Delta_y = -32767;
+    }
+    Wert = Teil[4] | ((unsigned int)Teil[5] << 8);
+    if(Wert > EXTERN_DELAY_MAX)
+    {
+        Wert = EXTERN_DELAY_MAX;
+    }
+    *Delay = Wert;
+    Extern_Lesen += EXTERN_TEILSTUECK;
+}
+
+/******************************************************************************\
+ * DRIFT_PRUEFEN fhrt nacheinander beide Achsen an ihren Referenzschalter,   *
+ * misst die Abweichung und fhrt wieder an die gemerkte Position zurck.     *
+ * Ohne RESET seit dem Einschalten wird nicht geprft.                        *
+ * Rckgabe: 1 = abgebrochen (Stopp-Taste oder Schalter nicht gefunden).      *
+\******************************************************************************/
+int DRIFT_PRUEFEN(int Korrigieren)
+{
+    int Betrag, Betrag_X, Betrag_Y;
+    
+    if(Referenziert == 0)
+    {
+        return 0;
+    }
+    
+    TRISG = 0x0000;                         // PORTG auf schreiben stellen
+    TRISA = 0x0000;                         // PORTA auf schreiben stellen
+    TRISB = 0x0000;                         // PORTB auf schreiben stellen
+    TRISE = 0x00cc;                         // Sensoren
+    
+    if((DRIFT_ACHSE(0x08, &Position_X, &Statistik.Drift_X, Korrigieren) == 1) ||
+       (DRIFT_ACHSE(0x04, &Position_Y, &Statistik.Drift_Y, Korrigieren) == 1))
+    {
+        Referenziert = 0;                   // Position nicht mehr sicher
+        return 1;
+    }
+    
+    Statistik.Drift_Pruefungen++;
+    Statistik.Drift_X_Summe += Statistik.Drift_X;
+    Statistik.Drift_Y_Summe += Statistik.Drift_Y;
+    Betrag_X = Statistik.Drift_X;
+    if(Betrag_X < 0)
+    {
+        Betrag_X = (-1)*Betrag_X;
+    }
+    Betrag_Y = Statistik.Drift_Y;
+    if(Betrag_Y < 0)
+    {
+        Betrag_Y = (-1)*Betrag_Y;
+    }
+    if(Betrag_X > Statistik.Drift_X_Max)
+    {
+        Statistik.Drift_X_Max = Betrag_X;
+    }
+    if(Betrag_Y > Statistik.Drift_Y_Max)
+    {
+        Statistik.Drift_Y_Max = Betrag_Y;
+    }
+    
+    Betrag = Betrag_X + Betrag_Y;
+    if(Betrag > 0x00FF)
+    {
+        Betrag = 0x00FF;
+    }
+    PORTA = Betrag;                         // Drift X + Y auf den LED's
+    ABSCHALTEN();
+    PORTA = 0x0000;
+    return 0;
+}
+
+int DRIFT_ACHSE(char Sensor, int *Position, int *Drift, int Korrigieren)
+{
+    int Delay;
+    int Ziel = *Position;                   // hierhin wird zurckgefahren
+    char LED = 0x00;
+    
+    ///////////////////////////////////////////////////////Zum Referenzschalter
+    while((PORTE & Sensor) != Sensor)
+    {
+        if((PORTD & 0x20) == 0x20)          // Stop mit Taster
+        {
+            return 1;
+        }
+        if(*Position < (-1)*(OFFSET_SCHRITTE + DRIFT_MAX))
+        {
+            return 1;                       // Schalter nicht gefunden
+        }
+        if(*Position > DRIFT_LANGSAM)
+        {
+            Delay = 300;
+        }
+        else
+        {
+            Delay = 500;                    // wie RESET_X_RICHTUNG / RESET_Y_RICHTUNG
+        }
+        if(Sensor == 0x08)
+        {
+            FAHREN(Delay, LED, 0x00, 0x40, 0x00, 0x00, 0, 0);
+        }
+        else
+        {
+            FAHREN(Delay, LED, 0x00, 0x00, 0x00, 0x10, 0, 0);
+        }
+    }
+    
+    *Drift = *Position + OFFSET_SCHRITTE;   // am Schalter gilt -OFFSET_SCHRITTE
+    if(Korrigieren == 1)
+    {
+        *Position = (-1)*OFFSET_SCHRITTE;
+    }
+    
+    ///////////////////////////////////////////////////////Zurck zur Position
+    while(*Position < Ziel)
+    {
+        if((((PORTE) & 0x40) == 0x40) || (((PORTE) & 0x80) == 0x80) || ((PORTD & 0x20) == 0x20))
+        {
+            return 1;
+        }
+        if(Sensor == 0x08)
+        {
+            FAHREN(300, LED, 0x08, 0x40, 0x00, 0x00, 0, 0);
+        }
+        else
+        {
+            FAHREN(300, LED, 0x00, 0x00, 0x04, 0x10, 0, 0);
+        }
+    }
+    return 0;
+}
+
+/******************************************************************************\
+ * JOGGEN: Schritt n der Rampe hat die Delay                                  *
+ * JOG_DELAY_START * (sqrt(n) - sqrt(n-1)), das ergibt eine konstante         *
+ * Beschleunigung. Es wird beschleunigt, solange die gewnschte Richtung      *
+ * gleich bleibt, sonst wird bis zum Stillstand gebremst (n Schritte). Die    *
+ * Delays werden vor dem Fahren in Jog_Delay berechnet, beim Fahren wird nur  *
+ * nachgeschlagen (sqrt in Software dauert lnger als ein Schritt).           *
+\******************************************************************************/
+int JOGGEN(void)
+{
+    char LED = 0xC3;
+    char X_DIR, Y_DIR, X_PUL, Y_PUL;
+    char Wunsch = 0;                        // gewnschte Richtungen (JOG_...)
+    char Aktiv = 0;                         // Richtungen der laufenden Fahrt
+    char Uart_Befehl = 0;
+    char Beenden = 0;
+    int n = 0;                              // Schritt in der Rampe, 0 = Stillstand
+    int Zeichen;
+    int Delay = JOG_DELAY_START;
+    int Jog_Delay[JOG_RAMPE + 1];
+    unsigned long Uart_Zeit = ZEIT() - JOG_HALTEN;  // letzter UART-Befehl
+    
+    TRISG = 0x0000;                         // PORTG auf schreiben stellen
+    TRISA = 0x0000;                         // PORTA auf schreiben stellen
+    TRISB = 0x0000;                         // PORTB auf schreiben stellen
+    TRISE = 0x00cc;                         // Sensoren
+    Fortschritt.Muster = MUSTER_KEINS;      // Joggen wird nicht gesichert
+    
+    Jog_Delay[0] = JOG_DELAY_START;
+    for(n=1;n <= JOG_RAMPE;n++)
+    {
+        Jog_Delay[n] = (int)(JOG_DELAY_START * (sqrt(n) - sqrt(n - 1)));
+        if(Jog_Delay[n] < DELAY_MOTOR)
+        {
+            Jog_Delay[n] = DELAY_MOTOR;
+        }
+    }
+    n = 0;
+    
+    while((PORTD & 0x20) == 0x20)           // Stopp-Taste erst loslassen
+    {
+        FAHREN(250, LED, 0x00, 0x00, 0x00, 0x00, 0, 0);
+    }
+    
+    while(1)
+    {
+        ///////////////////////////////////////////////////////Eingaben lesen
+        Zeichen = UART_LESEN();
+        switch(Zeichen)
+        {
+            case 'R':   Uart_Befehl = (Uart_Befehl & ~JOG_X_MINUS) | JOG_X_PLUS;
+                        break;
+            case 'L':   Uart_Befehl = (Uart_Befehl & ~JOG_X_PLUS) | JOG_X_MINUS;
+                        break;
+            case 'V':   Uart_Befehl = (Uart_Befehl & ~JOG_Y_MINUS) | JOG_Y_PLUS;
+                        break;
+            case 'H':   Uart_Befehl = (Uart_Befehl & ~JOG_Y_PLUS) | JOG_Y_MINUS;
+                        break;
+            case 'S':   Uart_Befehl = 0;
+                        break;
+            case 'E':   Beenden = 1;
+                        break;
+            default:    break;
+        }
+        if((Zeichen == 'R') || (Zeichen == 'L') || (Zeichen == 'V') || (Zeichen == 'H'))
+        {
+            Uart_Zeit = ZEIT();
+        }
+        if((ZEIT() - Uart_Zeit) >= JOG_HALTEN)  // Befehle wurden nicht wiederholt
+        {
+            Uart_Befehl = 0;
+        }
+        if((PORTD & 0x20) == 0x20)          // Stopp-Taste: Joggen beenden
+        {
+            Beenden = 1;
+        }
+        
+        Wunsch = (PORTD & 0x0F) | Uart_Befehl;
+        if((Wunsch & (JOG_X_PLUS | JOG_X_MINUS)) == (JOG_X_PLUS | JOG_X_MINUS))
+        {
+            Wunsch &= ~(JOG_X_PLUS | JOG_X_MINUS);
+        }
+        if((Wunsch & (JOG_Y_PLUS | JOG_Y_MINUS)) == (JOG_Y_PLUS | JOG_Y_MINUS))
+        {
+            Wunsch &= ~(JOG_Y_PLUS | JOG_Y_MINUS);
+        }
+        if(Beenden == 1)
+        {
+            Wunsch = 0;
+        }
+        Wunsch = JOG_GRENZEN(Wunsch, n + 1);
+        
+        ///////////////////////////////////////////////////////Rampe
+        if(n == 0)
+        {
+            Aktiv = Wunsch;
+            Delay = JOG_DELAY_START;
+        }
+        if(Aktiv == 0)                      // Stillstand
+        {
+            if(Beenden == 1)
+            {
+                break;
+            }
+            FAHREN(250, LED, 0x00, 0x00, 0x00, 0x00, 0, 0);
+            continue;
+        }
+        if(Wunsch == Aktiv)
+        {
+            if((Delay > DELAY_MOTOR) && (n < JOG_RAMPE))
+            {
+                n++;                        // beschleunigen
+            }
+        }
+        else
+        {
+            n--;                            // bremsen
+            if(n == 0)
+            {
+                continue;
+            }
+        }
+        Delay = Jog_Delay[n];
+        
+        ///////////////////////////////////////////////////////Schritt
+        if(JOG_GRENZEN(Aktiv, 1) != Aktiv)  // Schalter bettigt: sofort halten
+        {
+            n = 0;
+            Aktiv = 0;
+            continue;
+        }
+        X_PUL = 0x00;
+        Y_PUL = 0x00;
+        X_DIR = 0x00;
+        Y_DIR = 0x00;
+        if((Aktiv & (JOG_X_PLUS | JOG_X_MINUS)) != 0)
+        {
+            X_PUL = 0x40;
+        }
+        if((Aktiv & JOG_X_PLUS) != 0)
+        {
+            X_DIR = 0x08;
+        }
+        if((Aktiv & (JOG_Y_PLUS | JOG_Y_MINUS)) != 0)
+        {
+            Y_PUL = 0x10;
+        }
+        if((Aktiv & JOG_Y_PLUS) != 0)
+        {
+            Y_DIR = 0x04;
+        }
+        FAHREN(Delay, LED, X_DIR, X_PUL, Y_DIR, Y_PUL, 0, 0);
+    }
+    
+    while((PORTD & 0x20) == 0x20)           // Stopp-Taste loslassen
+    {
+        //warten
+    }
+    PORTA = 0x0000;
+    return 0;
+}
+
+/******************************************************************************\
+ * JOG_GRENZEN nimmt alle Richtungen weg, in denen ein Schalter bettigt ist  *
+ * oder (nach RESET) die Endlage innerhalb von Bremsweg Schritten liegt.      *
+\******************************************************************************/
+char JOG_GRENZEN(char Wunsch, int Bremsweg)
+{
+    if((PORTE & 0x08) == 0x08)              // Referenzschalter X
+    {
+        Wunsch &= ~JOG_X_MINUS;
+    }
+    if((PORTE & 0x04) == 0x04)              // Referenzschalter Y
+    {
+        Wunsch &= ~JOG_Y_MINUS;
+    }
+    if(((PORTE & 0x40) == 0x40) || ((PORTE & 0x80) == 0x80))
+    {
+        Wunsch &= ~(JOG_X_PLUS | JOG_Y_PLUS);
+    }
+    
+    if(Referenziert == 1)
+    {
+        if(Position_X + Bremsweg > X_MAX)
+        {
+            Wunsch &= ~JOG_X_PLUS;
+        }
+        if(Position_X - Bremsweg < 0)
+        {
+            Wunsch &= ~JOG_X_MINUS;
+        }
+        if(Position_Y + Bremsweg > Y_MAX)
+        {
+            Wunsch &= ~JOG_Y_PLUS;
+        }
+        if(Position_Y - Bremsweg < 0)
+        {
+            Wunsch &= ~JOG_Y_MINUS;
+        }
+    }
+    return Wunsch;
+}
+
+void UART_INIT(void)                        // UART2, 9600 Baud bei 4 MHz Fcy
+{
+    U2MODE = 0x0000;
+    U2BRG  = 25;
+    U2MODE = 0x8000;                        // UART ein
+    U2STA  = 0x0400;                        // Senden ein
+}
+
+int UART_LESEN(void)                        // -1 = kein Zeichen
+{
+    int Zeichen;
+    
+    if(U2STAbits.OERR == 1)
+    {
+        U2STAbits.OERR = 0;                 // berlauf verwerfen
+    }
+    if(U2STAbits.URXDA == 0)
+    {
+        return -1;
+    }
+    Zeichen = U2RXREG & 0x00FF;
+    if((Zeichen >= 'a') && (Zeichen <= 'z'))
+    {
+        Zeichen = Zeichen - 'a' + 'A';
+    }
+    return Zeichen;
+}
+
+void UART_SENDEN(const char *Text)          // blockiert, etwa 1 ms je Zeichen
+{
+    while(*Text != 0)
+    {
+        while(U2STAbits.UTXBF == 1)
+        {
+            //warten bis im Sendepuffer Platz ist
+        }
+        U2TXREG = *Text;
+        Text++;
+    }
+}
+
+void STATISTIK_AUSGEBEN(void)
+{
+    char Zeile[100];                        // reicht auch mit 64-Bit-long (tools/)
+    
+    snprintf(Zeile, sizeof(Zeile), "Position X %d, Y %d, referenziert %d\r\n", Position_X, Position_Y, (int)Referenziert);
+    UART_SENDEN(Zeile);
+    snprintf(Zeile, sizeof(Zeile), "Drift: %u Pruefungen, letzte X %d, Y %d\r\n",
+             Statistik.Drift_Pruefungen, Statistik.Drift_X, Statistik.Drift_Y);
+    UART_SENDEN(Zeile);
+    snprintf(Zeile, sizeof(Zeile), "Drift: Summe X %ld, Y %ld, max. X %d, Y %d\r\n",
+             Statistik.Drift_X_Summe, Statistik.Drift_Y_Summe, Statistik.Drift_X_Max, Statistik.Drift_Y_Max);
+    UART_SENDEN(Zeile);
+    snprintf(Zeile, sizeof(Zeile), "SPI-Flash: %d Muster, %u mal gewartet\r\n", Extern_Anzahl, Statistik.Extern_Warten);
+    UART_SENDEN(Zeile);
+}
+
+void ZEIT_INIT(void)                        // Timer2/3 als 32-Bit-Timer, 1:8
+{
+    T2CON = 0x0000;
+    T3CON = 0x0000;
+    TMR3 = 0;
+    TMR2 = 0;
+    PR3 = 0xFFFF;
+    PR2 = 0xFFFF;
+    T2CON = 0x8018;                         // TON, T32, Vorteiler 1:8
+}
+
+unsigned long ZEIT(void)
+{
+    unsigned int Unten;
+    
+    Unten = TMR2;                           // legt TMR3 in TMR3HLD ab
+    return ((unsigned long)TMR3HLD << 16) | Unten;
+}
+
+void WARTEN_BIS(unsigned long Ziel)
+{
+    while((long)(ZEIT() - Ziel) < 0)
+    {
+        if((Sicherung_Wort < SICHERUNG_WORTE) && ((long)(Ziel - ZEIT()) > SICHERUNG_WORT_TAKTE))
+        {
+            SICHERUNG_WEITER();             // ein Wort der Sicherung, passt noch in die Wartezeit
+        }
+        EXTERN_NACHLADEN();                 // warten, SPI-Flash nachladen
+    }
+}
+
+/******************************************************************************\
+ * TERMIN_WARTEN wartet auf den Termin der nchsten Flanke und plant die      *
+ * folgende Dauer spter (Termin += Dauer), danach schreibt der Aufrufer die  *
+ * Flanke. Der Termin bleibt absolut, eine Versptung wird in den nchsten    *
+ * Phasen eingeholt, aber keine Flanke wird frher als DELAY_MOTOR nach der   *
+ * vorigen (Flanke) geplant. Als Zeit der Flanke gilt ihr Ziel, solange       *
+ * WARTEN_BIS hchstens FLANKE_SPIEL Takte spter zurckkommt, sonst wrde    *
+ * jede Abfrage die folgenden Flanken an der Motorgrenze weiter schieben.     *
+ * Liegt der Termin mehr als Dauer zurck (Stillstand, Flash schreiben), wird *
+ * ab dieser Flanke neu geplant.                                              *
+\******************************************************************************/
+void TERMIN_WARTEN(unsigned int Dauer)
+{
+    unsigned long Jetzt = ZEIT();
+    unsigned long Ziel = Termin;
+    char Stillstand = 0;
+    
+    if((long)(Jetzt - Termin) > (long)Dauer)
+    {
+        Stillstand = 1;
+        Ziel = Jetzt;
+    }
+    if((Jetzt - Flanke < DELAY_MOTOR) && ((long)(Flanke + DELAY_MOTOR - Ziel) > 0))
+    {
+        Ziel = Flanke + DELAY_MOTOR;        // Motorgrenze
+    }
+    WARTEN_BIS(Ziel);
+    Jetzt = ZEIT();
+    Flanke = Ziel;
+    if((long)(Jetzt - Ziel) > FLANKE_SPIEL)
+    {
+        Flanke = Jetzt;                     // versptet: ab der wahren Flanke zhlen
+    }
+    if(Stillstand == 1)
+    {
+        Termin = Jetzt;                     // ab dieser Flanke neu planen
+    }
+    Termin += Dauer;
+}
+
+void WARTEN_MS(unsigned int Millisekunden)
+{
+    WARTEN_BIS(ZEIT() + Millisekunden*TAKTE_PRO_MS);
+}
+
+int TASTE(unsigned int Maske)               // 1 = Taste ENTPRELLEN lang gedrckt
+{
+    unsigned long Ende;
+    
+    if((PORTD & Maske) != Maske)
+    {
+        return 0;
+    }
+    Ende = ZEIT() + ENTPRELLEN;
+    while((long)(ZEIT() - Ende) < 0)
+    {
+        if((PORTD & Maske) != Maske)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/******************************************************************************\
+ * RADIEREN_ERZEUGEN erzeugt die Radierbahn der Art als Folge von Schenkeln   *
+ * (achsparallele Strecken) in einem Koordinatensystem mit der Start-Ecke im  *
+ * Ursprung und fhrt sie ab.                                                 *
+\******************************************************************************/
+void RADIEREN_ERZEUGEN(int Art)
+{
+    int n, u, Anzahl, Richtung, Versatz;
+    float Winkel;
+    
+    Bahn.Art = Art;
+    Bahn.Vorzeichen_x = 1;
+    Bahn.Vorzeichen_y = 1;
+    if((Art & 0x01) != 0)
+    {
+        Bahn.Vorzeichen_x = -1;
+    }
+    if((Art & 0x02) != 0)
+    {
+        Bahn.Vorzeichen_y = -1;
+    }
+    Bahn.Radius = RADIEREN_ABSTAND/2;
+    for(n=0;n <= RADIEREN_SEHNEN;n++)       // vor dem Fahren: sin/cos in Software ist langsam
+    {
+        Winkel = n*1.5707963/RADIEREN_SEHNEN;
+        Bahn.Sehnen_sin[n] = (int)floor(RADIEREN_EINS*sin(Winkel) + 0.5);
+        Bahn.Sehnen_cos[n] = (int)floor(RADIEREN_EINS*cos(Winkel) + 0.5);
+    }
+    Bahn.Abbruch = 0;
+    Bahn.Nummer = 0;
+    Bahn.Schenkel_offen = 0;
+    Bahn.Teil_offen = 0;
+    Bahn.Delay_Ecke = ECKE_DELAY(0, 0, 0, 0, RADIEREN_DELAY_MAX);  // aus dem Stillstand
+    
+    switch(Art/4)
+    {
+        case RADIEREN_RASTER:           // Bahnen in y-Richtung, Versatz in x
+            Richtung = 1;
+            u = 0;
+            while(Bahn.Abbruch == 0)
+            {
+                SCHENKEL(Richtung, Y_MAX);
+                if(u >= X_MAX)
+                {
+                    break;
+                }
+                Versatz = RADIEREN_ABSTAND;
+                if(Versatz > X_MAX - u)
+                {
+                    Versatz = X_MAX - u;
+                }
+                SCHENKEL(0, Versatz);
+                u += Versatz;
+                Richtung = 4 - Richtung;    // +y <-> -y
+            }
+            break;
+        
+        case RADIEREN_SPIRALE_INNEN:
+            for(n=0;(SPIRALE_SCHENKEL(n) > 0) && (Bahn.Abbruch == 0);n++)
+            {
+                SCHENKEL(n % 4, SPIRALE_SCHENKEL(n));
+            }
+            break;
+        
+        case RADIEREN_SPIRALE_AUSSEN:   // Spirale nach innen rckwrts
+            for(Anzahl=0;SPIRALE_SCHENKEL(Anzahl) > 0;Anzahl++)
+            {
+                //zhlen
+            }
+            for(n=Anzahl-1;(n >= 0) && (Bahn.Abbruch == 0);n--)
+            {
+                SCHENKEL((n + 2) % 4, SPIRALE_SCHENKEL(n));
+            }
+            break;
+        
+        default:
+            break;
+    }
+    SCHENKEL_ENDE();
+}
+
+/******************************************************************************\
+ * RADIEREN_DAUER schtzt die Dauer der Radierbahn in Takten ohne sie zu      *
+ * erzeugen: jeder Schritt der Bahnlnge mit der Motorgrenze, dazu je Ecke    *
+ * RADIEREN_ECKE_TAKTE fr Bogen und Rampen (statt 2*Radius gerade). Raster   *
+ * und Spiralen haben n Bahnen im Abstand RADIEREN_ABSTAND; die Spiralen      *
+ * unterscheiden sich nur im Startpunkt (Anfahrt rechnet Radieren dazu).      *
+ * Die Formel der Spirale gilt fr Y_MAX <= X_MAX (y-Schenkel enden zuerst).  *
+\******************************************************************************/
+unsigned long RADIEREN_DAUER(int Art)
+{
+    unsigned long Laenge, Bahnen, Ecken;
+    
+    if(Art/4 == RADIEREN_RASTER)
+    {
+        Bahnen = (X_MAX + RADIEREN_ABSTAND - 1)/RADIEREN_ABSTAND + 1;
+        Laenge = Bahnen*Y_MAX + X_MAX;      // Bahnen in y, Verstze in x
+        Ecken = 2*(Bahnen - 1);
+    }
+    else
+    {
+        Bahnen = (Y_MAX + RADIEREN_ABSTAND - 1)/RADIEREN_ABSTAND;
+        Laenge = X_MAX + Bahnen*(X_MAX + Y_MAX) - RADIEREN_ABSTAND*Bahnen*(Bahnen - 1);
+        Ecken = 2*Bahnen;                   // je Umlauf ein Schenkel in x und einer in y
+    }
+    return 2UL*DELAY_MOTOR*(Laenge - Ecken*RADIEREN_ABSTAND) + Ecken*RADIEREN_ECKE_TAKTE;
+}
+
+int SPIRALE_SCHENKEL(int n)                 // Lnge des Schenkels n der Spirale nach innen
+{
+    if(n == 0)
+    {
+        return X_MAX;
+    }
+    if((n % 2) == 0)
+    {
+        return X_MAX - RADIEREN_ABSTAND*((n - 1)/2);
+    }
+    return Y_MAX - RADIEREN_ABSTAND*((n - 1)/2);
+}
+
+void RADIEREN_START(int Art, int *Start_x, int *Start_y)  // absolute Startposition
+{
+    int n, u = 0, v = 0;
+    
+    if(Art/4 == RADIEREN_SPIRALE_AUSSEN)    // Ende der Spirale nach innen
+    {
+        for(n=0;SPIRALE_SCHENKEL(n) > 0;n++)
+        {
+            u += Richtung_x[n % 4]*SPIRALE_SCHENKEL(n);
+            v += Richtung_y[n % 4]*SPIRALE_SCHENKEL(n);
+        }
+    }
+    *Start_x = u;
+    *Start_y = v;
+    if((Art & 0x01) != 0)
+    {
+        *Start_x = X_MAX - u;
+    }
+    if((Art & 0x02) != 0)
+    {
+        *Start_y = Y_MAX - v;
+    }
+}
+
+/******************************************************************************\
+ * SCHENKEL hngt eine achsparallele Strecke an. Zwischen zwei Schenkeln im   *
+ * rechten Winkel werden beide um den Radius gekrzt und mit einem            *
+ * Viertelkreis verbunden. Der Radius wird so verkleinert, dass vom neuen     *
+ * Schenkel noch die Hlfte fr die nchste Ecke bleibt.                      *
+\******************************************************************************/
+void SCHENKEL(int Richtung, int Laenge)
+{
+    int Radius;
+    
+    if(Laenge <= 0)
+    {
+        return;
+    }
+    if(Bahn.Schenkel_offen == 0)
+    {
+        Bahn.Richtung = Richtung;
+        Bahn.Rest = Laenge;
+        Bahn.Schenkel_offen = 1;
+        return;
+    }
+    if(Richtung == Bahn.Richtung)
+    {
+        Bahn.Rest += Laenge;
+        return;
+    }
+    
+    Radius = Bahn.Radius;
+    if(Radius > Bahn.Rest)
+    {
+        Radius = Bahn.Rest;
+    }
+    if(Radius > Laenge/2)
+    {
+        Radius = Laenge/2;
+    }
+    GERADE(Bahn.Richtung, Bahn.Rest - Radius);
+    BOGEN(Bahn.Richtung, Richtung, Radius);
+    Bahn.Richtung = Richtung;
+    Bahn.Rest = Laenge - Radius;
+}
+
+void SCHENKEL_ENDE(void)
+{
+    if(Bahn.Schenkel_offen == 1)
+    {
+        GERADE(Bahn.Richtung, Bahn.Rest);
+        Bahn.Schenkel_offen = 0;
+    }
+    if(Bahn.Teil_offen == 1)
+    {
+        TEIL_FAHREN(0, 0);                  // letztes Teilstck hat keinen Nachfolger
+        Bahn.Teil_offen = 0;
+    }
+}
+
+void GERADE(int Richtung, int Laenge)
+{
+    if(Laenge > 0)
+    {
+        TEIL(Richtung_x[Richtung]*Laenge, Richtung_y[Richtung]*Laenge);
+    }
+}
+
+void BOGEN(int Richtung_alt, int Richtung_neu, int Radius) // Viertelkreis aus Sehnen
+{
+    int t, Punkt_x, Punkt_y, Alt_x = 0, Alt_y = 0;
+    
+    if(Radius <= 0)
+    {
+        return;
+    }
+    for(t=1;t <= RADIEREN_SEHNEN;t++)       // >> rundet auch negative Werte ab (wie floor)
+    {
+        Punkt_x = (int)(((long)Radius*(Richtung_x[Richtung_alt]*Bahn.Sehnen_sin[t] + Richtung_x[Richtung_neu]*(RADIEREN_EINS - Bahn.Sehnen_cos[t])) + RADIEREN_EINS/2) >> RADIEREN_EINS_BITS);
+        Punkt_y = (int)(((long)Radius*(Richtung_y[Richtung_alt]*Bahn.Sehnen_sin[t] + Richtung_y[Richtung_neu]*(RADIEREN_EINS - Bahn.Sehnen_cos[t])) + RADIEREN_EINS/2) >> RADIEREN_EINS_BITS);
+        TEIL(Punkt_x - Alt_x, Punkt_y - Alt_y);
+        Alt_x = Punkt_x;
+        Alt_y = Punkt_y;
+    }
+}
+
+void TEIL(int Delta_x, int Delta_y)         // Teilstck merken, Vorgnger fahren
+{
+    if((Delta_x == 0) && (Delta_y == 0))
+    {
+        return;
+    }
+    Delta_x = Delta_x*Bahn.Vorzeichen_x;
+    Delta_y = Delta_y*Bahn.Vorzeichen_y;
+    if(Bahn.Teil_offen == 1)
+    {
+        TEIL_FAHREN(Delta_x, Delta_y);
+    }
+    Bahn.Offen_x = Delta_x;
+    Bahn.Offen_y = Delta_y;
+    Bahn.Teil_offen = 1;
+}
+
+void TEIL_FAHREN(int Nach_x, int Nach_y)    // offenes Teilstck fahren
+{
+    int Delay;
+    
+    if(Bahn.Abbruch == 1)
+    {
+        return;
+    }
+    Delay = ECKE_DELAY(Bahn.Offen_x, Bahn.Offen_y, Nach_x, Nach_y, RADIEREN_DELAY_MAX);
+    if(Bahn.Nummer >= Bahn.k_Start)
+    {
+        Fortschritt.k = Bahn.Nummer;
+        Fortschritt.i = Bahn.Art;
+        if(SEGMENT_FAHREN(Bahn.Offen_x, Bahn.Offen_y, DELAY_MOTOR, Bahn.Delay_Ecke, Delay, 0x00, Bahn.j_Start) == 1)
+        {
+            Bahn.Abbruch = 1;
+        }
+        Bahn.j_Start = 0;
     }
+    Bahn.Nummer++;
+    Bahn.Delay_Ecke = Delay;                    // Ecke am Ende ist der Anfang des nchsten
 }
 
@@ -0,0 +1,639 @@
+/******************************************************************************\
+ * File:        sim.c                                                         *
+ * Description: Simulierte Hardware für den Host-Build von Sandplotter.c      *
+ *              (Beschreibung siehe sim.h).                                   *
+\******************************************************************************/
+
+/***Header-Dateien*************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "xc.h"
+/******************************************************************************/
+
+/***Register*******************************************************************/
+volatile unsigned int LATA, TRISA, PORTA, TRISB, PORTB, TRISD, TRISE, TRISF, TRISG, PORTG;
+volatile unsigned int T2CON, T3CON, TMR3, TMR3HLD, PR2, PR3;
+volatile unsigned int NVMCON, TBLPAG;
+volatile unsigned int SPI1STAT, SPI1CON1, SPI1CON2;
+volatile unsigned int U2MODE, U2STA, U2BRG;
+volatile SIM_NVMCON_BITS NVMCONbits;
+/******************************************************************************/
+
+/***Globale Variablen**********************************************************/
+#define UNBESCHRIEBEN   0x10000             // Merker in Spi_Wert, Tx_Wert (siehe SPI-Flash)
+
+SIM_ZUSTAND Sim;
+
+static unsigned int Tmr2_Wert;
+static unsigned int Portd_Wert;
+static unsigned int Porte_Wert;
+static SIM_U2STA_BITS U2sta_Wert;
+static unsigned int U2rx_Wert;
+
+static unsigned int Alt_G;                  // PORTG bei der letzten Abtastung
+static char Motoren_aus = 1;                // ENA war seit der letzten Flanke aus
+static unsigned long long Letzte_X;         // Zeit der letzten Flanke je Achse
+static unsigned long long Letzte_Y;
+static unsigned long long Periode_X;        // letzter Abstand je Achse, 0 = Achse steht
+static unsigned long long Periode_Y;
+static int Richtung_X;                      // Richtung der letzten Flanke je Achse
+static int Richtung_Y;
+static unsigned long long Naechster_Ablauf;
+static unsigned long Zufall = 12345;
+
+static FILE *Spur;
+
+static char Uart_Text[4096];
+static int Uart_Lesen, Uart_Laenge;
+static unsigned long long Uart_Termin;
+static unsigned int Tx_Wert = UNBESCHRIEBEN;   // U2TXREG
+static unsigned long long Tx_Ende;          // letztes Zeichen ist hinausgeschoben
+
+static unsigned int Flash[SIM_FLASH_PAGES*SIM_FLASH_PAGE];
+static unsigned int Flash_Adresse, Flash_Wert;  // Zwischenspeicher (TBLWTL)
+static FILE *Flash_Datei;
+
+static unsigned int Spi_Wert = UNBESCHRIEBEN;  // SPI1BUF, wie ihn die Firmware sieht
+static unsigned int Spi_Empfangen = 0xFF;
+static unsigned long long Spi_Fertig;       // Ende des laufenden Bytes
+static SIM_SPI1STAT_BITS Spi_Status = {1};
+static SIM_LATF_BITS Latf_Wert = {1}, Latf_Alt = {1};
+static int Spi_Zustand;                     // 0 Befehl, 1-3 Adresse, 4 Daten, 5 unbekannt
+static unsigned long Spi_Adresse;
+static unsigned char *Spi_Bild;
+static unsigned long Spi_Groesse;
+/******************************************************************************/
+
+static void ABTASTEN(void);
+static void SCHRITT(int Achse, int Richtung, int Pruefen);
+static void SPRUNG(unsigned long long Alt, unsigned long long Neu, int Umkehr);
+static void WEITER(unsigned long Takte);
+static void FLASH_SPEICHERN(unsigned int Anfang, unsigned int Anzahl);
+static void SPI_ABTASTEN(void);
+
+void SIM_START(int Start_X, int Start_Y)
+{
+    void (*Ablauf)(void) = Sim.Ablauf;
+    void (*Flanke)(int, int) = Sim.Flanke;
+    long Verlust = Sim.Verlust_ppm;
+    unsigned long Latenz = Sim.Spi_Latenz;
+    FILE *Ausgabe = Sim.Uart_Ausgabe;
+
+    memset(&Sim, 0, sizeof(Sim));
+    Sim.Ablauf = Ablauf;
+    Sim.Flanke = Flanke;
+    Sim.Verlust_ppm = Verlust;
+    Sim.Spi_Latenz = Latenz;
+    Sim.Uart_Ausgabe = Ausgabe;
+    Sim.X = Start_X;
+    Sim.Y = Start_Y;
+    Sim.Min_Periode_X = ~0UL;
+    Sim.Min_Periode_Y = ~0UL;
+    PORTG = 0;
+    PORTB = 0;
+    Alt_G = 0;
+    Motoren_aus = 1;
+    Letzte_X = 0;
+    Letzte_Y = 0;
+    Periode_X = 0;
+    Periode_Y = 0;
+    Richtung_X = 0;
+    Richtung_Y = 0;
+    Naechster_Ablauf = 0;
+    Uart_Lesen = 0;
+    Uart_Laenge = 0;
+    memset(Flash, 0xFF, sizeof(Flash));
+    Tx_Wert = UNBESCHRIEBEN;
+    Tx_Ende = 0;
+    Spi_Wert = UNBESCHRIEBEN;
+    Spi_Status.SPIRBF = 1;
+    Latf_Wert.LATF2 = 1;
+    Latf_Alt.LATF2 = 1;
+    Spi_Zustand = 0;
+}
+
+int SIM_MOTOREN_AN(void)
+{
+    return (PORTB & 0xC000) != 0;
+}
+
+/******************************************************************************\
+ * Spur: "SPUR", Version (16 Bit), 0 (16 Bit), dann je Schritt Zeit (32 Bit), *
+ * X und Y (je 16 Bit mit Vorzeichen), alles little-endian.                   *
+\******************************************************************************/
+int SIM_SPUR(const char *Datei)
+{
+    unsigned char Kopf[8] = {'S', 'P', 'U', 'R', 1, 0, 0, 0};
+
+    Spur = fopen(Datei, "wb");
+    if(Spur == NULL)
+    {
+        return 1;
+    }
+    fwrite(Kopf, 1, sizeof(Kopf), Spur);
+    return 0;
+}
+
+void SIM_SPUR_ENDE(void)
+{
+    if(Spur != NULL)
+    {
+        fclose(Spur);
+        Spur = NULL;
+    }
+}
+
+void SIM_UART(const char *Text)
+{
+    int n = strlen(Text);
+
+    if(Uart_Lesen == Uart_Laenge)
+    {
+        Uart_Lesen = 0;
+        Uart_Laenge = 0;
+    }
+    if(Uart_Laenge + n > (int)sizeof(Uart_Text))
+    {
+        n = sizeof(Uart_Text) - Uart_Laenge;
+    }
+    memcpy(&Uart_Text[Uart_Laenge], Text, n);
+    Uart_Laenge += n;
+}
+
+/***Zeit***********************************************************************/
+volatile unsigned int *SIM_TMR2(void)
+{
+    ABTASTEN();
+    WEITER(1);
+    Tmr2_Wert = Sim.Zeit & 0xFFFF;
+    TMR3HLD = (Sim.Zeit >> 16) & 0xFFFF;
+    return &Tmr2_Wert;
+}
+
+void SIM_RECHNEN(unsigned int Takte)
+{
+    ABTASTEN();
+    WEITER(Takte);
+}
+
+static void WEITER(unsigned long Takte)
+{
+    Sim.Zeit += Takte;
+    if((Sim.Ablauf != NULL) && (Sim.Zeit >= Naechster_Ablauf))
+    {
+        Naechster_Ablauf = Sim.Zeit + 500;  // 1 ms
+        Sim.Ablauf();
+    }
+}
+/******************************************************************************/
+
+/***Motoren********************************************************************/
+static void ABTASTEN(void)
+{
+    unsigned int G = PORTG;
+    unsigned int Steigend = G & ~Alt_G;
+    int Pruefen;
+
+    SPI_ABTASTEN();
+    if((Tx_Wert & UNBESCHRIEBEN) == 0)      // Firmware hat ein Zeichen gesendet
+    {
+        if(Sim.Uart_Ausgabe != NULL)
+        {
+            fputc(Tx_Wert & 0xFF, Sim.Uart_Ausgabe);
+        }
+        Tx_Ende = ((Tx_Ende > Sim.Zeit) ? Tx_Ende : Sim.Zeit) + SIM_TAKTE_ZEICHEN;
+        Tx_Wert = UNBESCHRIEBEN;
+    }
+    Alt_G = G;
+    if(((PORTB & 0xC000) == 0) && (Motoren_aus == 0))
+    {
+        SIM_HALT();                         // abgeschaltet: beide Achsen stehen
+        Motoren_aus = 1;
+    }
+    Pruefen = (Motoren_aus == 0);           // gilt für beide Achsen dieser Flanke
+    if(((Steigend & 0x4000) != 0) && ((PORTB & 0x8000) != 0))
+    {
+        SCHRITT(0, ((PORTB & 0x0800) != 0) ? 1 : -1, Pruefen);
+    }
+    if(((Steigend & 0x1000) != 0) && ((PORTB & 0x4000) != 0))
+    {
+        SCHRITT(1, ((PORTB & 0x0400) != 0) ? 1 : -1, Pruefen);
+    }
+}
+
+static void SCHRITT(int Achse, int Richtung, int Pruefen)
+{
+    unsigned long long *Letzte = (Achse == 0) ? &Letzte_X : &Letzte_Y;
+    unsigned long long *Periode = (Achse == 0) ? &Periode_X : &Periode_Y;
+    int *Letzte_Richtung = (Achse == 0) ? &Richtung_X : &Richtung_Y;
+    unsigned long *Min_Periode = (Achse == 0) ? &Sim.Min_Periode_X : &Sim.Min_Periode_Y;
+    unsigned char Satz[8];
+
+    /////////////////////////////////////////////////////////////Zeitverhalten
+    if(Pruefen)
+    {
+        if(Sim.Zeit - *Letzte < *Min_Periode)
+        {
+            *Min_Periode = Sim.Zeit - *Letzte;
+        }
+        SPRUNG(*Periode, Sim.Zeit - *Letzte, Richtung != *Letzte_Richtung);
+        *Periode = Sim.Zeit - *Letzte;
+    }
+    else
+    {
+        *Periode = 0;                       // erste Flanke nach dem Einschalten: aus dem Stillstand
+    }
+    *Letzte = Sim.Zeit;
+    *Letzte_Richtung = Richtung;
+    Motoren_aus = 0;
+
+    /////////////////////////////////////////////////////////////Position
+    Zufall = Zufall*1103515245UL + 12345;
+    if((long)((Zufall >> 8) % 1000000) < Sim.Verlust_ppm)
+    {
+        Sim.Verloren++;                     // Motor hat den Schritt nicht gemacht
+        return;
+    }
+    if(Achse == 0)
+    {
+        Sim.X += Richtung;
+        Sim.Schritte_X++;
+    }
+    else
+    {
+        Sim.Y += Richtung;
+        Sim.Schritte_Y++;
+    }
+    if(Spur != NULL)
+    {
+        Satz[0] = Sim.Zeit & 0xFF;
+        Satz[1] = (Sim.Zeit >> 8) & 0xFF;
+        Satz[2] = (Sim.Zeit >> 16) & 0xFF;
+        Satz[3] = (Sim.Zeit >> 24) & 0xFF;
+        Satz[4] = Sim.X & 0xFF;
+        Satz[5] = (Sim.X >> 8) & 0xFF;
+        Satz[6] = Sim.Y & 0xFF;
+        Satz[7] = (Sim.Y >> 8) & 0xFF;
+        fwrite(Satz, 1, sizeof(Satz), Spur);
+    }
+    if(Sim.Flanke != NULL)
+    {
+        Sim.Flanke(Achse, Richtung);
+    }
+}
+
+/******************************************************************************\
+ * Geschwindigkeitssprung einer Achse zwischen zwei Abständen (0 = steht):    *
+ * |1/Neu - 1/Alt| darf nicht größer sein als 1/SIM_START_PERIODE, das        *
+ * Anfahren aus dem Stillstand mit der Start-Stopp-Frequenz. Kehrt die Achse  *
+ * um (Umkehr), hält sie dazwischen an: beide Abstände wie beim Anhalten und  *
+ * Anfahren. SIM_SPIEL deckt ab, dass jede Flanke ein paar Takte nach ihrem   *
+ * Termin kommt.                                                              *
+\******************************************************************************/
+static void SPRUNG(unsigned long long Alt, unsigned long long Neu, int Umkehr)
+{
+    unsigned long long Zaehler, Nenner;
+    unsigned long Schritte_s;
+
+    if((Alt == 0) && (Neu == 0))
+    {
+        return;
+    }
+    if(Alt == 0)                            // anfahren: 1/Neu
+    {
+        Zaehler = 1;
+        Nenner = Neu;
+    }
+    else if(Neu == 0)                       // anhalten: 1/Alt
+    {
+        Zaehler = 1;
+        Nenner = Alt;
+    }
+    else
+    {
+        Zaehler = (Alt > Neu) ? Alt - Neu : Neu - Alt;
+        Nenner = Alt*Neu;
+        if(Umkehr)                          // anhalten und anfahren: 1/kürzerer Abstand
+        {
+            Zaehler = 1;
+            Nenner = (Alt < Neu) ? Alt : Neu;
+        }
+    }
+    Schritte_s = (unsigned long)(Zaehler*SIM_TAKTE_S/Nenner);
+    if(Schritte_s > Sim.Max_Sprung)
+    {
+        Sim.Max_Sprung = Schritte_s;
+    }
+    if(Zaehler*(SIM_START_PERIODE - SIM_SPIEL) > Nenner)
+    {
+        Sim.Spruenge++;
+    }
+}
+
+void SIM_HALT(void)
+{
+    SPRUNG(Periode_X, 0, 0);
+    SPRUNG(Periode_Y, 0, 0);
+    Periode_X = 0;
+    Periode_Y = 0;
+}
+/******************************************************************************/
+
+/***Tasten, Sensoren, UART*****************************************************/
+volatile unsigned int *SIM_PORTD(void)
+{
+    ABTASTEN();
+    WEITER(1);
+    Portd_Wert = Sim.Tasten;
+    Sim.Tasten_gelesen = Sim.Zeit;
+    return &Portd_Wert;
+}
+
+volatile unsigned int *SIM_PORTE(void)
+{
+    ABTASTEN();
+    WEITER(1);
+    Porte_Wert = 0;
+    if(Sim.X <= -SIM_OFFSET)
+    {
+        Porte_Wert |= 0x08;
+    }
+    if(Sim.Y <= -SIM_OFFSET)
+    {
+        Porte_Wert |= 0x04;
+    }
+    if(Sim.X >= SIM_ENDE)
+    {
+        Porte_Wert |= 0x40;
+    }
+    if(Sim.Y >= SIM_ENDE)
+    {
+        Porte_Wert |= 0x80;
+    }
+    return &Porte_Wert;
+}
+
+volatile SIM_U2STA_BITS *SIM_U2STABITS(void)
+{
+    ABTASTEN();
+    WEITER(1);
+    U2sta_Wert.URXDA = (Uart_Lesen < Uart_Laenge) && (Sim.Zeit >= Uart_Termin);
+    U2sta_Wert.UTXBF = (Tx_Ende > Sim.Zeit + 4*SIM_TAKTE_ZEICHEN);   // 4 Zeichen FIFO
+    return &U2sta_Wert;
+}
+
+volatile unsigned int *SIM_U2RXREG(void)
+{
+    ABTASTEN();
+    WEITER(1);
+    U2rx_Wert = 0;
+    if(Uart_Lesen < Uart_Laenge)
+    {
+        U2rx_Wert = (unsigned char)Uart_Text[Uart_Lesen];
+        Uart_Lesen++;
+        Uart_Termin = Sim.Zeit + SIM_TAKTE_ZEICHEN;
+    }
+    return &U2rx_Wert;
+}
+
+volatile unsigned int *SIM_U2TXREG(void)
+{
+    ABTASTEN();
+    WEITER(1);
+    Tx_Wert = UNBESCHRIEBEN;
+    return &Tx_Wert;
+}
+/******************************************************************************/
+
+/***SPI-Flash*****************************************************************/
+/******************************************************************************\
+ * SPI1BUF und LATFbits sind Variablen, die die Firmware direkt beschreibt.   *
+ * Ein Schreibzugriff wird beim nächsten Zugriff auf die simulierte Hardware  *
+ * erkannt: an CS am geänderten LATF2, an SPI1BUF am gelöschten Merker        *
+ * UNBESCHRIEBEN (gelesen wird immer Byte | UNBESCHRIEBEN). U2TXREG ebenso.   *
+\******************************************************************************/
+int SIM_SPI_DATEI(const char *Datei)
+{
+    FILE *Bild = fopen(Datei, "rb");
+    long Groesse;
+
+    if(Bild == NULL)
+    {
+        return 1;
+    }
+    fseek(Bild, 0, SEEK_END);
+    Groesse = ftell(Bild);
+    fseek(Bild, 0, SEEK_SET);
+    free(Spi_Bild);
+    Spi_Bild = malloc((Groesse > 0) ? Groesse : 1);
+    if((Spi_Bild == NULL) || (fread(Spi_Bild, 1, Groesse, Bild) != (size_t)Groesse))
+    {
+        fclose(Bild);
+        return 1;
+    }
+    fclose(Bild);
+    Spi_Groesse = Groesse;
+    return 0;
+}
+
+static unsigned char SPI_ANTWORT(unsigned char Empfangen)
+{
+    unsigned char Antwort = 0xFF;
+
+    switch(Spi_Zustand)
+    {
+        case 0:
+            Spi_Zustand = (Empfangen == 0x03) ? 1 : 5;
+            Spi_Adresse = 0;
+            if(Empfangen == 0x03)
+            {
+                Sim.Spi_Lesebefehle++;
+            }
+            break;
+        case 1:
+        case 2:
+        case 3:
+            Spi_Adresse = (Spi_Adresse << 8) | Empfangen;
+            Spi_Zustand++;
+            break;
+        case 4:
+            if(Spi_Adresse < Spi_Groesse)
+            {
+                Antwort = Spi_Bild[Spi_Adresse];
+            }
+            Spi_Adresse = (Spi_Adresse + 1) & 0xFFFFFF;
+            break;
+        default:
+            break;
+    }
+    return Antwort;
+}
+
+static void SPI_ABTASTEN(void)
+{
+    if(Latf_Wert.LATF2 != Latf_Alt.LATF2)
+    {
+        Latf_Alt.LATF2 = Latf_Wert.LATF2;
+        Spi_Zustand = 0;                    // jede CS-Flanke beendet den Befehl
+    }
+    if((Spi_Wert & UNBESCHRIEBEN) == 0)     // Firmware hat ein Byte geschrieben
+    {
+        Spi_Empfangen = 0xFF;
+        if(Latf_Alt.LATF2 == 0)
+        {
+            Spi_Empfangen = SPI_ANTWORT(Spi_Wert & 0xFF);
+        }
+        Spi_Wert = UNBESCHRIEBEN;
+        Spi_Status.SPIRBF = 0;
+        Spi_Fertig = Sim.Zeit + SIM_TAKTE_SPI + Sim.Spi_Latenz;
+        Sim.Spi_Bytes++;
+    }
+    if((Spi_Status.SPIRBF == 0) && (Sim.Zeit >= Spi_Fertig))
+    {
+        Spi_Status.SPIRBF = 1;
+    }
+}
+
+volatile unsigned int *SIM_SPI1BUF(void)
+{
+    ABTASTEN();
+    WEITER(1);
+    Spi_Wert = UNBESCHRIEBEN | Spi_Empfangen;
+    return &Spi_Wert;
+}
+
+volatile SIM_SPI1STAT_BITS *SIM_SPI1STATBITS(void)
+{
+    ABTASTEN();
+    WEITER(1);
+    return &Spi_Status;
+}
+
+volatile SIM_LATF_BITS *SIM_LATFBITS(void)
+{
+    ABTASTEN();
+    WEITER(1);
+    return &Latf_Wert;
+}
+/******************************************************************************/
+
+/***Programmspeicher***********************************************************/
+/******************************************************************************\
+ * Datei: je Befehlswort 16 Bit little-endian, SIM_FLASH_PAGES Pages. Fehlt   *
+ * die Datei, wird sie gelöscht (0xFFFF) angelegt. Jede Flash-Operation wird  *
+ * sofort in die Datei geschrieben.                                           *
+\******************************************************************************/
+int SIM_FLASH_DATEI(const char *Datei)
+{
+    unsigned char Wort[2];
+    unsigned int n;
+
+    Flash_Datei = fopen(Datei, "r+b");
+    if(Flash_Datei != NULL)
+    {
+        for(n=0;(n < SIM_FLASH_PAGES*SIM_FLASH_PAGE) && (fread(Wort, 1, 2, Flash_Datei) == 2);n++)
+        {
+            Flash[n] = Wort[0] | (Wort[1] << 8);
+        }
+        return 0;
+    }
+    Flash_Datei = fopen(Datei, "w+b");
+    if(Flash_Datei == NULL)
+    {
+        return 1;
+    }
+    FLASH_SPEICHERN(0, SIM_FLASH_PAGES*SIM_FLASH_PAGE);
+    return 0;
+}
+
+static void FLASH_SPEICHERN(unsigned int Anfang, unsigned int Anzahl)
+{
+    unsigned char Wort[2];
+    unsigned int n;
+
+    if(Flash_Datei == NULL)
+    {
+        return;
+    }
+    fseek(Flash_Datei, 2L*Anfang, SEEK_SET);
+    for(n=Anfang;n < Anfang + Anzahl;n++)
+    {
+        Wort[0] = Flash[n] & 0xFF;
+        Wort[1] = (Flash[n] >> 8) & 0xFF;
+        fwrite(Wort, 1, 2, Flash_Datei);
+    }
+    fflush(Flash_Datei);
+}
+
+unsigned int SIM_TBLRDL(unsigned int Adresse)
+{
+    if(Adresse/2 >= SIM_FLASH_PAGES*SIM_FLASH_PAGE)
+    {
+        return 0xFFFF;
+    }
+    return Flash[Adresse/2] & 0xFFFF;
+}
+
+void SIM_TBLWTL(unsigned int Adresse, unsigned int Wert)
+{
+    Flash_Adresse = Adresse/2;
+    Flash_Wert = Wert & 0xFFFF;
+}
+
+void SIM_NVM(void)
+{
+    unsigned int Page = Flash_Adresse / SIM_FLASH_PAGE;
+
+    ABTASTEN();
+    if(Page >= SIM_FLASH_PAGES)
+    {
+        fprintf(stderr, "sim: Flash-Zugriff außerhalb (Wort %u)\n", Flash_Adresse);
+        exit(2);
+    }
+    if(NVMCON == 0x4042)                    // Page löschen
+    {
+        if(SIM_MOTOREN_AN())
+        {
+            Sim.Loeschen_Im_Lauf++;
+        }
+        memset(&Flash[Page*SIM_FLASH_PAGE], 0xFF, SIM_FLASH_PAGE*sizeof(Flash[0]));
+        FLASH_SPEICHERN(Page*SIM_FLASH_PAGE, SIM_FLASH_PAGE);
+        Sim.Flash_Loeschungen[Page]++;
+        WEITER(SIM_TAKTE_PAGE);             // CPU steht während des Löschens
+    }
+    else if(NVMCON == 0x4003)               // ein Wort programmieren
+    {
+        Flash[Flash_Adresse] &= Flash_Wert; // es können nur Bits gelöscht werden
+        FLASH_SPEICHERN(Flash_Adresse, 1);
+        Sim.Flash_Worte++;
+        WEITER(SIM_TAKTE_WORT);
+    }
+    NVMCONbits.WR = 0;
+}
+/******************************************************************************/
+
+void SIM_BERICHT(FILE *Ausgabe)
+{
+    int n;
+    unsigned long Summe = 0, Hoechste = 0;
+
+    for(n=0;n < SIM_FLASH_PAGES;n++)
+    {
+        Summe += Sim.Flash_Loeschungen[n];
+        if(Sim.Flash_Loeschungen[n] > Hoechste)
+        {
+            Hoechste = Sim.Flash_Loeschungen[n];
+        }
+    }
+    fprintf(Ausgabe, "Zeit            %.3f s\n", Sim.Zeit/500000.0);
+    fprintf(Ausgabe, "Position        X %d, Y %d\n", Sim.X, Sim.Y);
+    fprintf(Ausgabe, "Schritte        X %lu, Y %lu, verloren %lu\n", Sim.Schritte_X, Sim.Schritte_Y, Sim.Verloren);
+    fprintf(Ausgabe, "kürzeste Periode X %lu, Y %lu Takte\n",
+            (Sim.Min_Periode_X == ~0UL) ? 0 : Sim.Min_Periode_X,
+            (Sim.Min_Periode_Y == ~0UL) ? 0 : Sim.Min_Periode_Y);
+    fprintf(Ausgabe, "Sprünge         %lu über dem Start aus dem Stillstand (Periode %d), höchstens %lu Schritte/s\n",
+            Sim.Spruenge, SIM_START_PERIODE, Sim.Max_Sprung);
+    fprintf(Ausgabe, "SPI-Flash       %lu Bytes, %lu Lesebefehle\n", Sim.Spi_Bytes, Sim.Spi_Lesebefehle);
+    fprintf(Ausgabe, "Flash           %lu Worte, %lu Page-Löschungen (höchstens %lu je Page), %lu bei laufenden Motoren\n",
+            Sim.Flash_Worte, Summe, Hoechste, Sim.Loeschen_Im_Lauf);
+}
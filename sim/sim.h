@@ -0,0 +1,117 @@
+/******************************************************************************\
+ * File:        sim.h                                                         *
+ * Description: Simulierte Hardware für den Host-Build von Sandplotter.c.     *
+ *                                                                            *
+ * Zeit:      Ein Takt ist ein Takt von Timer2/3 (2 us). Jeder Zugriff auf    *
+ *            ein Register mit Verhalten (TMR2, PORTD, PORTE, UART) schiebt   *
+ *            die Zeit um einen Takt weiter, Gleitkommaaufrufe und Flash-     *
+ *            Operationen um ihre geschätzte Dauer.                           *
+ * Motoren:   PORTG/PORTB werden bei jedem Zugriff auf die simulierte         *
+ *            Hardware abgetastet. Eine steigende PUL-Flanke bei gesetztem    *
+ *            ENA ist ein Schritt der wahren Position Sim.X/Sim.Y, optional   *
+ *            wird er in eine Spur-Datei geschrieben.                         *
+ * Sensoren:  PORTE folgt aus der wahren Position (Referenzschalter bei       *
+ *            -SIM_OFFSET, Endschalter bei SIM_ENDE).                         *
+ * Flash:     Die Sicherung liegt in einem RAM-Abbild des Programmspeichers, *
+ *            mit SIM_FLASH_DATEI auch in einer Datei (bleibt über mehrere   *
+ *            Läufe erhalten, wie nach dem Aus- und Einschalten).            *
+ * SPI:       Ein SPI-NOR-Flash an SPI1 (CS RF2) versteht READ (0x03) und     *
+ *            liefert das Abbild aus SIM_SPI_DATEI, dahinter 0xFF. Ein Byte   *
+ *            dauert SIM_TAKTE_SPI plus Sim.Spi_Latenz Takte.                 *
+ * Sprünge:   Aus den Abständen der Flanken jeder Achse folgt ihre            *
+ *            Geschwindigkeit. Zwischen zwei Abständen darf sie sich nicht    *
+ *            stärker ändern als beim Anfahren aus dem Stillstand mit         *
+ *            SIM_START_PERIODE, auch nicht beim Anhalten (Abschalten,        *
+ *            SIM_HALT), nach einer Pause oder beim Umkehren der Achse.       *
+\******************************************************************************/
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdio.h>
+
+/***Schätzwerte (Takte zu 2 us bei Fcy = 4 MHz)********************************/
+#define SIM_TAKTE_WURZEL        40      // Software-sqrt, etwa 320 Zyklen
+#define SIM_TAKTE_WINKEL        200     // sin/cos
+#define SIM_TAKTE_RUNDEN        10      // floor
+#define SIM_TAKTE_WORT          20      // Flash: ein Befehlswort programmieren
+#define SIM_TAKTE_PAGE          10000   // Flash: eine Page löschen (20 ms)
+#define SIM_TAKTE_ZEICHEN       520     // UART 9600 Baud, etwa 1 ms
+#define SIM_TAKTE_SPI           4       // ein Byte bei 1 MHz
+#define SIM_TAKTE_S             500000ULL   // Takte je Sekunde
+#define SIM_START_PERIODE       320     // Start-Stopp-Frequenz (wie 2*DELAY_STILLSTAND)
+#define SIM_SPIEL               4       // Abfrage in WARTEN_BIS (wie FLANKE_SPIEL)
+/******************************************************************************/
+
+/***Tisch**********************************************************************/
+#define SIM_OFFSET              100     // Referenzschalter bei -SIM_OFFSET
+#define SIM_ENDE                11500   // Endschalter X (0x40) bzw. Y (0x80)
+#define SIM_FLASH_PAGES         16      // simulierter Bereich der Sicherung
+#define SIM_FLASH_PAGE          512     // Befehlsworte je Page
+/******************************************************************************/
+
+typedef struct { unsigned WR:1; } SIM_NVMCON_BITS;
+typedef struct { unsigned SPIRBF:1; } SIM_SPI1STAT_BITS;
+typedef struct { unsigned LATF2:1; } SIM_LATF_BITS;
+typedef struct { unsigned URXDA:1; unsigned OERR:1; unsigned UTXBF:1; } SIM_U2STA_BITS;
+
+typedef struct
+{
+    unsigned long long Zeit;            // Takte seit dem Start
+    int X;                              // wahre Position in Schritten
+    int Y;
+    unsigned int Tasten;                // gedrückte Tasten (PORTD)
+    unsigned long long Tasten_gelesen;  // Zeit des letzten Zugriffs auf PORTD
+    long Verlust_ppm;                   // so viele Schritte pro Million gehen verloren
+    unsigned long Spi_Latenz;           // zusätzliche Takte je SPI-Byte
+    FILE *Uart_Ausgabe;                 // gesendete Zeichen (NULL = verwerfen)
+
+    unsigned long Schritte_X;
+    unsigned long Schritte_Y;
+    unsigned long Verloren;
+    unsigned long Min_Periode_X;        // kürzester Abstand zweier Flanken
+    unsigned long Min_Periode_Y;
+    unsigned long Spruenge;             // zu große Geschwindigkeitssprünge
+    unsigned long Max_Sprung;           // größter Sprung in Schritten/s
+
+    unsigned long Flash_Worte;
+    unsigned long Flash_Loeschungen[SIM_FLASH_PAGES];
+    unsigned long Loeschen_Im_Lauf;     // Page gelöscht, während ENA an war
+
+    unsigned long Spi_Bytes;
+    unsigned long Spi_Lesebefehle;
+
+    void (*Ablauf)(void);               // wird jede Millisekunde aufgerufen
+    void (*Flanke)(int Achse, int Richtung); // nach jedem Schritt (0 = X, 1 = Y)
+} SIM_ZUSTAND;
+
+extern SIM_ZUSTAND Sim;
+
+/***Steuerung aus den Host-Programmen******************************************/
+void SIM_START(int Start_X, int Start_Y);
+int SIM_SPUR(const char *Datei);            // 0 = ok
+void SIM_SPUR_ENDE(void);
+int SIM_FLASH_DATEI(const char *Datei);     // 0 = ok, nach SIM_START aufrufen
+int SIM_SPI_DATEI(const char *Datei);       // 0 = ok, Abbild des SPI-Flash
+void SIM_UART(const char *Text);            // Zeichen über UART2 empfangen
+int SIM_MOTOREN_AN(void);
+void SIM_HALT(void);                        // Achsen stehen: Anhalten prüfen
+void SIM_BERICHT(FILE *Ausgabe);
+/******************************************************************************/
+
+/***Zugriffe aus der Firmware (über xc.h)**************************************/
+volatile unsigned int *SIM_TMR2(void);
+volatile unsigned int *SIM_PORTD(void);
+volatile unsigned int *SIM_PORTE(void);
+volatile SIM_U2STA_BITS *SIM_U2STABITS(void);
+volatile unsigned int *SIM_U2RXREG(void);
+volatile unsigned int *SIM_U2TXREG(void);
+volatile unsigned int *SIM_SPI1BUF(void);
+volatile SIM_SPI1STAT_BITS *SIM_SPI1STATBITS(void);
+volatile SIM_LATF_BITS *SIM_LATFBITS(void);
+void SIM_RECHNEN(unsigned int Takte);
+unsigned int SIM_TBLRDL(unsigned int Adresse);
+void SIM_TBLWTL(unsigned int Adresse, unsigned int Wert);
+void SIM_NVM(void);
+/******************************************************************************/
+
+#endif
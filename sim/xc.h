@@ -0,0 +1,57 @@
+/******************************************************************************\
+ * File:        xc.h (Host-Build)                                             *
+ * Description: Ersatz für den XC16-Header, damit Sandplotter.c mit gcc auf   *
+ *              dem PC übersetzt werden kann (tools/, test/). Einfache        *
+ *              Register sind Variablen, Register mit Verhalten (Zeit,        *
+ *              Tasten, Sensoren, SPI) gehen an die simulierte Hardware in    *
+ *              sim.c.                                                        *
+\******************************************************************************/
+#ifndef SIM_XC_H
+#define SIM_XC_H
+
+#include <math.h>
+#include "sim.h"
+
+/***Register ohne Verhalten****************************************************/
+extern volatile unsigned int LATA, TRISA, PORTA, TRISB, PORTB, TRISD, TRISE, TRISF, TRISG, PORTG;
+extern volatile unsigned int T2CON, T3CON, TMR3, TMR3HLD, PR2, PR3;
+extern volatile unsigned int NVMCON, TBLPAG;
+extern volatile unsigned int SPI1STAT, SPI1CON1, SPI1CON2;
+extern volatile unsigned int U2MODE, U2STA, U2BRG;
+
+extern volatile SIM_NVMCON_BITS NVMCONbits;
+/******************************************************************************/
+
+/***Register mit Verhalten*****************************************************/
+#define TMR2            (*SIM_TMR2())       // jeder Zugriff ist ein Takt
+#define PORTD           (*SIM_PORTD())      // Tasten aus dem Ablauf
+#define PORTE           (*SIM_PORTE())      // Schalter aus der wahren Position
+#define U2STAbits       (*SIM_U2STABITS())
+#define U2RXREG         (*SIM_U2RXREG())
+#define U2TXREG         (*SIM_U2TXREG())    // nach Sim.Uart_Ausgabe
+#define SPI1BUF         (*SIM_SPI1BUF())    // SPI-Flash mit Musterabbild
+#define SPI1STATbits    (*SIM_SPI1STATBITS())
+#define LATFbits        (*SIM_LATFBITS())   // RF2 = CS des SPI-Flash
+/******************************************************************************/
+
+/***Programmspeicher (Sicherung)***********************************************/
+#define space(x)                    unused
+#define __builtin_tblpage(x)        0
+#define __builtin_tbloffset(x)      0
+#define __builtin_tblrdl(a)         SIM_TBLRDL(a)
+#define __builtin_tblwtl(a, w)      SIM_TBLWTL(a, w)
+#define __builtin_tblwth(a, w)      ((void)0)
+#define __builtin_write_NVM()       SIM_NVM()
+/******************************************************************************/
+
+/***Rechenzeit*****************************************************************/
+// Gleitkomma wird auf dem dsPIC in Software gerechnet. Die Bibliotheks-
+// aufrufe kosten deshalb simulierte Zeit (Schätzwerte in sim.h), alles
+// andere zählt als kostenlos.
+#define sqrt(x)         (SIM_RECHNEN(SIM_TAKTE_WURZEL), sqrt(x))
+#define sin(x)          (SIM_RECHNEN(SIM_TAKTE_WINKEL), sin(x))
+#define cos(x)          (SIM_RECHNEN(SIM_TAKTE_WINKEL), cos(x))
+#define floor(x)        (SIM_RECHNEN(SIM_TAKTE_RUNDEN), floor(x))
+/******************************************************************************/
+
+#endif
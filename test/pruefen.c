@@ -0,0 +1,454 @@
+/******************************************************************************\
+ * File:        pruefen.c                                                     *
+ * Description: Eigenschaftstest für die Bahnplanung von Sandplotter.c gegen  *
+ *              die simulierte Hardware (../sim).                             *
+ *                                                                            *
+ * Zufällige Folgen von Teilstücken und Delays werden wie in den Mustern      *
+ * über SCHLEIFE_BERECHNEN, SEGMENT_FAHREN (mit Eckrampen) und ECKE_DELAY     *
+ * gefahren, jede Folge noch einmal gespiegelt und/oder mit getauschten       *
+ * Achsen. Geprüft wird je Fall:                                              *
+ *   - die wahre Endposition (Sim.X/Sim.Y) und Position_X/Position_Y sind     *
+ *     genau die Summe der Teilstücke,                                        *
+ *   - keine Flanke kommt früher als 2*DELAY_MOTOR nach der vorigen derselben *
+ *     Achse,                                                                 *
+ *   - jede Flanke kommt höchstens TOLERANZ Takte neben ihrer Zeit im Plan,   *
+ *     den PLANEN allein aus Teilstücken und Delays aufstellt (Phasen wie in  *
+ *     FAHREN, Rampen wie in SEGMENT_FAHREN, gezählt ab der ersten Flanke),   *
+ *   - keine Achse ändert ihre Geschwindigkeit stärker als beim Anfahren aus  *
+ *     dem Stillstand (Sim.Spruenge, mit Anfahren und Anhalten),              *
+ *   - die umgeformte Folge dauert genauso lange.                             *
+ * Dazu kommen SCHLEIFE_BERECHNEN und ECKE_DELAY allein für viele Werte.      *
+ *                                                                            *
+ * Aufruf: pruefen [Fälle [Startwert]]                                        *
+\******************************************************************************/
+
+/***Header-Dateien*************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "sim.h"
+/******************************************************************************/
+
+#define DELAY_MOTOR     80                  // wie in Sandplotter.c
+#define DELAY_STILLSTAND (2*DELAY_MOTOR)    // wie in Sandplotter.c
+#define ECKE_SCHRITTE   64                  // wie in Sandplotter.c
+#define MITTE           5600                // Start jedes Falls
+#define RAND            200                 // Abstand zu den Schaltern
+#define TEILE_MAX       40
+#define FLANKEN_MAX     (TEILE_MAX*1500 + 1)    // je Achse
+#define TOLERANZ        10                  // Takte neben dem Plan
+
+/***Firmware*******************************************************************/
+int SEGMENT_FAHREN(int Delta_x, int Delta_y, int Delay, int Delay_Anfang, int Delay_Ende, char LED, int j_Start);
+int ECKE_DELAY(int A_x, int A_y, int B_x, int B_y, int Delay_max);
+int SCHLEIFE_BERECHNEN(int Positionsanfahrt_x, int Positionsanfahrt_y, int *X_Schleife, int *Y_Schleife);
+unsigned long ZEIT(void);
+extern unsigned long Termin, Flanke;
+extern int Letzte_Phase, Letzter_Anteil_X, Letzter_Anteil_Y;
+extern int Position_X, Position_Y;
+/******************************************************************************/
+
+static unsigned long Zufall;
+static int Fehler;
+
+static unsigned long Plan[2][FLANKEN_MAX];  // Zeit jeder Flanke ab der ersten, je Achse
+static long Geplant[2], Gekommen[2];        // Anzahl geplant bzw. gefahren
+static unsigned long long Beginn;           // Sim.Zeit der ersten Flanke
+static unsigned long Abweichend, Max_Abweichung;
+
+static int ZUFALL(int Von, int Bis)         // gleichverteilt in [Von, Bis]
+{
+    Zufall = Zufall*1103515245UL + 12345;
+    return Von + (int)((Zufall >> 8) % (unsigned long)(Bis - Von + 1));
+}
+
+static void FEHLER(int Fall, const char *Text, long Ist, long Soll)
+{
+    printf("FEHLER Fall %d: %s ist %ld, soll %ld\n", Fall, Text, Ist, Soll);
+    Fehler++;
+}
+
+/******************************************************************************\
+ * Die Schleife muss jede Achse genau um ihren Betrag bewegen: ein einfacher  *
+ * Schritt je Durchlauf bis zum Betrag, ein zusätzlicher je Schnell-Durchlauf.*
+\******************************************************************************/
+static void SCHLEIFEN_PRUEFEN(void)
+{
+    int x, y, Schleife, X_Schleife, Y_Schleife, Schritte_x, Schritte_y;
+
+    for(x=0;x <= 300;x++)
+    {
+        for(y=0;y <= 300;y++)
+        {
+            Schleife = SCHLEIFE_BERECHNEN(x, y, &X_Schleife, &Y_Schleife);
+            Schritte_x = ((Schleife < x) ? Schleife : x) + X_Schleife;
+            Schritte_y = ((Schleife < y) ? Schleife : y) + Y_Schleife;
+            if((Schritte_x != x) || (Schritte_y != y) || (X_Schleife > Schleife) || (Y_Schleife > Schleife))
+            {
+                printf("FEHLER SCHLEIFE_BERECHNEN(%d, %d): Schleife %d, X_Schleife %d, Y_Schleife %d\n",
+                       x, y, Schleife, X_Schleife, Y_Schleife);
+                Fehler++;
+                return;
+            }
+        }
+    }
+}
+
+/******************************************************************************\
+ * ECKE_DELAY liegt zwischen DELAY_MOTOR und Delay_max, angehoben höchstens   *
+ * auf 2*DELAY_STILLSTAND (Umkehr einer Achse). Ab diesem Delay_max ergibt    *
+ * gerade weiter DELAY_MOTOR, ab 90° und am Stillstand Delay_max, und ein     *
+ * spitzerer Knick nie weniger.                                               *
+\******************************************************************************/
+static void ECKEN_PRUEFEN(void)
+{
+    int n, A_x, A_y, B_x, B_y, Delay_max, Delay, Spitzer, Obergrenze;
+
+    for(n=0;n < 100000;n++)
+    {
+        A_x = ZUFALL(-3000, 3000);
+        A_y = ZUFALL(-3000, 3000);
+        B_x = ZUFALL(-3000, 3000);
+        B_y = ZUFALL(-3000, 3000);
+        Delay_max = ZUFALL(DELAY_MOTOR, 2000);
+        Delay = ECKE_DELAY(A_x, A_y, B_x, B_y, Delay_max);
+        Obergrenze = (Delay_max > 2*DELAY_STILLSTAND) ? Delay_max : 2*DELAY_STILLSTAND;
+        if((Delay < DELAY_MOTOR) || (Delay > Obergrenze))
+        {
+            printf("FEHLER ECKE_DELAY(%d, %d, %d, %d, %d) = %d\n", A_x, A_y, B_x, B_y, Delay_max, Delay);
+            Fehler++;
+            return;
+        }
+        if(Delay_max < 2*DELAY_STILLSTAND)  // darunter darf die Anhebung überwiegen
+        {
+            continue;
+        }
+        if(((A_x != 0) || (A_y != 0)) && (ECKE_DELAY(A_x, A_y, 2*A_x, 2*A_y, Delay_max) != DELAY_MOTOR))
+        {
+            printf("FEHLER ECKE_DELAY: gerade Fortsetzung von (%d, %d) bremst\n", A_x, A_y);
+            Fehler++;
+            return;
+        }
+        if(((A_x != 0) || (A_y != 0)) && (ECKE_DELAY(A_x, A_y, -A_y, A_x, Delay_max) != Delay_max))
+        {
+            printf("FEHLER ECKE_DELAY: 90° nach (%d, %d) nicht Delay_max\n", A_x, A_y);
+            Fehler++;
+            return;
+        }
+        if((ECKE_DELAY(A_x, A_y, 0, 0, Delay_max) != Delay_max) || (ECKE_DELAY(0, 0, B_x, B_y, Delay_max) != Delay_max))
+        {
+            printf("FEHLER ECKE_DELAY: Stillstand bei (%d, %d), (%d, %d) nicht Delay_max\n", A_x, A_y, B_x, B_y);
+            Fehler++;
+            return;
+        }
+        Spitzer = ECKE_DELAY(A_x, A_y, -B_x, -B_y, Delay_max);  // Knick 180° - alter Knick
+        if(((long)A_x*B_x + (long)A_y*B_y > 0) && (Spitzer < Delay))
+        {
+            printf("FEHLER ECKE_DELAY(%d, %d, %d, %d): spitzer Knick %d < %d\n", A_x, A_y, B_x, B_y, Spitzer, Delay);
+            Fehler++;
+            return;
+        }
+    }
+}
+
+/******************************************************************************\
+ * Erlaubte Phasen einer Achse, die im vorigen Durchlauf (Phase, 0 =          *
+ * Stillstand) Alt und im nächsten Neu halbe Schritte je zwei Phasen macht:   *
+ * |Neu/Phase_neu - Alt/Phase| <= 1/(DELAY_STILLSTAND/2), gerundet wie in der *
+ * Firmware (Beträge, eine Umkehr deckt ECKE_DELAY ab).                       *
+\******************************************************************************/
+static void GRENZEN(long Phase, long Alt, long Neu, long *Unten, long *Oben)
+{
+    const long Grenze = DELAY_STILLSTAND/2;
+    long Schnellstens, Langsamstens;
+
+    if(Neu == 0)
+    {
+        return;
+    }
+    if(Phase == 0)
+    {
+        Alt = 0;
+        Phase = 1;
+    }
+    Schnellstens = Alt*Grenze + Phase;      // Nenner von Alt/Phase + 1/Grenze
+    Langsamstens = Alt*Grenze - Phase;      // Nenner von Alt/Phase - 1/Grenze
+    if((Neu*Grenze*Phase + Schnellstens - 1)/Schnellstens > *Unten)
+    {
+        *Unten = (Neu*Grenze*Phase + Schnellstens - 1)/Schnellstens;
+    }
+    if((Langsamstens > 0) && (Neu*Grenze*Phase/Langsamstens < *Oben))
+    {
+        *Oben = Neu*Grenze*Phase/Langsamstens;
+    }
+}
+
+/******************************************************************************\
+ * Plan einer Folge ohne die Firmware-Zeitbasis: je Durchlauf die Phase wie   *
+ * in SEGMENT_FAHREN (Motorgrenze, Eckrampen, Anfang nie schneller als das    *
+ * Ende des vorigen Teilstücks, Sprung je Achse begrenzt wie in               *
+ * SPRUNG_BEGRENZEN), daraus die steigenden Flanken wie in FAHREN:            *
+ * normal eine je Achse in zwei Phasen, Schnell zwei der schnellen Achse im   *
+ * Abstand von zwei Phasen und eine der anderen in vier Phasen.               *
+\******************************************************************************/
+static void PLANEN(const int *Teil_x, const int *Teil_y, int Anzahl, int Delay, int Delay_max)
+{
+    int i, j, Betrag_x, Betrag_y, Schleife, X_Schleife, Y_Schleife, Schnell, Rest;
+    int Delay_i, Delay_j, Rampe, Delay_Anfang, Delay_Ende, Phase = 0;
+    int Anteil[2], Alt[2] = {0, 0};
+    long Unten, Oben;
+    unsigned long t = 0;
+
+    Geplant[0] = 0;
+    Geplant[1] = 0;
+    Delay_Anfang = ECKE_DELAY(0, 0, Teil_x[0], Teil_y[0], Delay_max);
+    for(i=0;i < Anzahl;i++)
+    {
+        Delay_Ende = ECKE_DELAY(Teil_x[i], Teil_y[i], Teil_x[i+1], Teil_y[i+1], Delay_max);
+        Betrag_x = abs(Teil_x[i]);
+        Betrag_y = abs(Teil_y[i]);
+        Schleife = SCHLEIFE_BERECHNEN(Betrag_x, Betrag_y, &X_Schleife, &Y_Schleife);
+        Delay_Anfang = (Phase > Delay_Anfang) ? Phase : Delay_Anfang;
+        Delay_i = (Delay == 0) ? DELAY_MOTOR : Delay;
+        if((X_Schleife > 0) || (Y_Schleife > 0))
+        {
+            Delay_i = ((Delay_i < 2*DELAY_MOTOR) ? 2*DELAY_MOTOR : Delay_i)/2;
+        }
+        else if(Delay_i < DELAY_MOTOR)
+        {
+            Delay_i = DELAY_MOTOR;
+        }
+        for(j=0;j < Schleife;j++)
+        {
+            Schnell = (j < X_Schleife) || (j < Y_Schleife);
+            Delay_j = Delay_i;
+            if((j < ECKE_SCHRITTE) && (Delay_Anfang > Delay_i))
+            {
+                Delay_j = Delay_Anfang - (int)((unsigned long)(Delay_Anfang - Delay_i)*j/ECKE_SCHRITTE);
+            }
+            Rest = Schleife - 1 - j;
+            if((Rest < ECKE_SCHRITTE) && (Delay_Ende > Delay_i))
+            {
+                Rampe = Delay_Ende - (int)((unsigned long)(Delay_Ende - Delay_i)*Rest/ECKE_SCHRITTE);
+                Delay_j = (Rampe > Delay_j) ? Rampe : Delay_j;
+            }
+            Anteil[0] = (j < Betrag_x) ? ((j < Y_Schleife) ? 1 : 2) : 0;
+            Anteil[1] = (j < Betrag_y) ? ((j < X_Schleife) ? 1 : 2) : 0;
+            Unten = 0;
+            Oben = Delay_j;
+            GRENZEN(Phase, Alt[0], Anteil[0], &Unten, &Oben);
+            GRENZEN(Phase, Alt[1], Anteil[1], &Unten, &Oben);
+            Delay_j = (Delay_j > Oben) ? (int)Oben : Delay_j;
+            Delay_j = (Delay_j < Unten) ? (int)Unten : Delay_j;
+            if(j < Betrag_x)
+            {
+                Plan[0][Geplant[0]++] = t;
+            }
+            if(j < Betrag_y)
+            {
+                Plan[1][Geplant[1]++] = t;
+            }
+            if(j < X_Schleife)
+            {
+                Plan[0][Geplant[0]++] = t + 2*Delay_j;
+            }
+            if(j < Y_Schleife)
+            {
+                Plan[1][Geplant[1]++] = t + 2*Delay_j;
+            }
+            t += Schnell ? 4*Delay_j : 2*Delay_j;
+            Phase = Delay_j;
+            Alt[0] = Anteil[0];
+            Alt[1] = Anteil[1];
+        }
+        Delay_Anfang = Delay_Ende;
+    }
+}
+
+static void FLANKE(int Achse, int Richtung)     // Sim.Flanke: gegen den Plan
+{
+    unsigned long Abweichung;
+    long long Differenz;
+
+    if((Gekommen[0] == 0) && (Gekommen[1] == 0))
+    {
+        Beginn = Sim.Zeit;                  // der Plan beginnt mit der ersten Flanke
+    }
+    if(Gekommen[Achse] >= Geplant[Achse])
+    {
+        Gekommen[Achse]++;                  // zu viele, fällt bei der Position auf
+        return;
+    }
+    Differenz = (long long)(Sim.Zeit - Beginn) - (long long)Plan[Achse][Gekommen[Achse]];
+    Gekommen[Achse]++;
+    Abweichung = (unsigned long)((Differenz < 0) ? -Differenz : Differenz);
+    if(Abweichung > Max_Abweichung)
+    {
+        Max_Abweichung = Abweichung;
+    }
+    if(Abweichung > TOLERANZ)
+    {
+        Abweichend++;
+    }
+}
+
+/******************************************************************************\
+ * Fährt eine Folge ab MITTE wie ein Muster (Stillstand an Anfang und Ende)   *
+ * und prüft sie. Rückgabe: Dauer von der ersten Flanke bis zum Ende.         *
+\******************************************************************************/
+static unsigned long FOLGE_FAHREN(int Fall, const int *Teil_x, const int *Teil_y, int Anzahl, int Delay, int Delay_max)
+{
+    int i, Ziel_x = MITTE, Ziel_y = MITTE;
+    int Delay_Anfang, Delay_Ende;
+
+    for(i=0;i < Anzahl;i++)
+    {
+        Ziel_x += Teil_x[i];
+        Ziel_y += Teil_y[i];
+    }
+    PLANEN(Teil_x, Teil_y, Anzahl, Delay, Delay_max);
+    Gekommen[0] = 0;
+    Gekommen[1] = 0;
+    Abweichend = 0;
+    Max_Abweichung = 0;
+
+    SIM_START(MITTE, MITTE);
+    Beginn = Sim.Zeit;
+    Termin = ZEIT() - SIM_TAKTE_S;          // Sim.Zeit beginnt neu: wie nach 1 s Stillstand
+    Flanke = Termin;
+    Letzte_Phase = 0;                       // wie nach ABSCHALTEN
+    Letzter_Anteil_X = 0;
+    Letzter_Anteil_Y = 0;
+    Position_X = MITTE;
+    Position_Y = MITTE;
+    Delay_Anfang = ECKE_DELAY(0, 0, Teil_x[0], Teil_y[0], Delay_max);  // aus dem Stillstand
+    for(i=0;i < Anzahl;i++)
+    {
+        Delay_Ende = ECKE_DELAY(Teil_x[i], Teil_y[i], Teil_x[i+1], Teil_y[i+1], Delay_max);
+        if(SEGMENT_FAHREN(Teil_x[i], Teil_y[i], (Delay == 0) ? DELAY_MOTOR : Delay, Delay_Anfang, Delay_Ende, 0x00, 0) == 1)
+        {
+            FEHLER(Fall, "abgebrochen in Teilstück", i, Anzahl);
+            return 0;
+        }
+        Delay_Anfang = Delay_Ende;
+    }
+    SIM_HALT();                             // in den Stillstand
+
+    if(Sim.X != Ziel_x)
+    {
+        FEHLER(Fall, "wahre Position X", Sim.X, Ziel_x);
+    }
+    if(Sim.Y != Ziel_y)
+    {
+        FEHLER(Fall, "wahre Position Y", Sim.Y, Ziel_y);
+    }
+    if((Position_X != Ziel_x) || (Position_Y != Ziel_y))
+    {
+        FEHLER(Fall, "Position_X/Y weicht ab, X", Position_X, Ziel_x);
+    }
+    if((Gekommen[0] != Geplant[0]) || (Gekommen[1] != Geplant[1]))
+    {
+        FEHLER(Fall, "Flanken gegenüber dem Plan, X", Gekommen[0], Geplant[0]);
+    }
+    if((Sim.Schritte_X > 1) && (Sim.Min_Periode_X < 2*DELAY_MOTOR))
+    {
+        FEHLER(Fall, "kürzeste Periode X", Sim.Min_Periode_X, 2*DELAY_MOTOR);
+    }
+    if((Sim.Schritte_Y > 1) && (Sim.Min_Periode_Y < 2*DELAY_MOTOR))
+    {
+        FEHLER(Fall, "kürzeste Periode Y", Sim.Min_Periode_Y, 2*DELAY_MOTOR);
+    }
+    if(Abweichend != 0)
+    {
+        FEHLER(Fall, "Flanken neben dem Plan", Abweichend, 0);
+    }
+    if(Sim.Spruenge != 0)
+    {
+        FEHLER(Fall, "Geschwindigkeitssprünge", Sim.Spruenge, 0);
+    }
+    return (unsigned long)(Sim.Zeit - Beginn);
+}
+
+/******************************************************************************\
+ * Ein Fall: zufällige Teilstücke (kurze mit ungeraden Beträgen ebenso wie    *
+ * lange), feste Delay wie bei den externen Mustern (0 = Motorgrenze, auch    *
+ * Werte unter der Motorgrenze), Delay_max für die Ecken. Die Bahn bleibt so  *
+ * nah an MITTE, dass sie auch gespiegelt und getauscht auf den Tisch passt.  *
+ * Umformung: Bit 0 spiegelt X, Bit 1 spiegelt Y, Bit 2 tauscht die Achsen.   *
+\******************************************************************************/
+static void FALL(int Fall)
+{
+    int Teil_x[TEILE_MAX + 1], Teil_y[TEILE_MAX + 1];
+    int Form_x[TEILE_MAX + 1], Form_y[TEILE_MAX + 1];
+    int Anzahl, i, Groesse, Umformung, Weg_x = 0, Weg_y = 0;
+    int Delay, Delay_max;
+    unsigned long Schritte, Dauer, Dauer_Form;
+    double Sekunden;
+
+    Anzahl = ZUFALL(1, TEILE_MAX);
+    Groesse = (ZUFALL(0, 3) == 0) ? 3 : ((ZUFALL(0, 1) == 0) ? 60 : 1500);
+    for(i=0;i < Anzahl;i++)
+    {
+        do
+        {
+            Teil_x[i] = ZUFALL(-Groesse, Groesse);
+            Teil_y[i] = ZUFALL(-Groesse, Groesse);
+        }
+        while((abs(Weg_x + Teil_x[i]) > MITTE - RAND) || (abs(Weg_y + Teil_y[i]) > MITTE - RAND));
+        Weg_x += Teil_x[i];
+        Weg_y += Teil_y[i];
+    }
+    Teil_x[Anzahl] = 0;
+    Teil_y[Anzahl] = 0;
+    Delay = (ZUFALL(0, 2) == 0) ? 0 : ZUFALL(DELAY_MOTOR/2, 400);
+    Delay_max = ZUFALL(DELAY_MOTOR, 1200);
+    Umformung = ZUFALL(1, 7);
+    for(i=0;i <= Anzahl;i++)
+    {
+        Form_x[i] = (Umformung & 4) ? Teil_y[i] : Teil_x[i];
+        Form_y[i] = (Umformung & 4) ? Teil_x[i] : Teil_y[i];
+        Form_x[i] = (Umformung & 1) ? -Form_x[i] : Form_x[i];
+        Form_y[i] = (Umformung & 2) ? -Form_y[i] : Form_y[i];
+    }
+
+    Dauer_Form = FOLGE_FAHREN(Fall, Form_x, Form_y, Anzahl, Delay, Delay_max);
+    Dauer = FOLGE_FAHREN(Fall, Teil_x, Teil_y, Anzahl, Delay, Delay_max);
+    if(labs((long)Dauer - (long)Dauer_Form) > TOLERANZ)
+    {
+        FEHLER(Fall, "Dauer umgeformt", Dauer_Form, Dauer);
+    }
+
+    Schritte = Sim.Schritte_X + Sim.Schritte_Y;
+    Sekunden = Dauer/500000.0;
+    printf("Fall %3d: %2d Teile bis %4d, Delay %3d, Delay_max %4d, Umformung %d: %6lu Schritte in %7.3f s, "
+           "%5.0f Schritte/s, Periode >= %lu, Plan +-%lu, Sprung <= %lu/s\n",
+           Fall, Anzahl, Groesse, Delay, Delay_max, Umformung, Schritte, Sekunden,
+           (Sekunden > 0) ? Schritte/Sekunden : 0.0,
+           (Sim.Min_Periode_X < Sim.Min_Periode_Y) ? Sim.Min_Periode_X : Sim.Min_Periode_Y,
+           Max_Abweichung, Sim.Max_Sprung);
+}
+
+int main(int argc, char **argv)
+{
+    int Faelle = 60, n;
+
+    if(argc > 1)
+    {
+        Faelle = atoi(argv[1]);
+    }
+    Zufall = (argc > 2) ? strtoul(argv[2], NULL, 0) : 2016;
+    Sim.Flanke = FLANKE;
+
+    SCHLEIFEN_PRUEFEN();
+    ECKEN_PRUEFEN();
+    for(n=0;n < Faelle;n++)
+    {
+        FALL(n);
+    }
+    if(Fehler != 0)
+    {
+        printf("%d Fehler\n", Fehler);
+        return 1;
+    }
+    printf("ok: SCHLEIFE_BERECHNEN, ECKE_DELAY, %d Fälle\n", Faelle);
+    return 0;
+}
@@ -0,0 +1,149 @@
+/******************************************************************************\
+ * File:        musterbild.c                                                  *
+ * Description: Baut aus Musterdateien (Text) das Abbild für den externen     *
+ *              Musterspeicher (SPI-Flash, Aufbau siehe Sandplotter.c).       *
+ *                                                                            *
+ * Aufruf: musterbild bild muster ...                                         *
+ * Musterdatei: erste Zeile "LED Delay_max", danach je Zeile ein Teilstück    *
+ *              "delta_X delta_Y [Delay]" (Delay fehlt = 0 = Motorgrenze).    *
+ *              LED 0 bis 255, Delay_max DELAY_MOTOR bis DELAY_MAX, Delay 0   *
+ *              bis DELAY_MAX, delta -32767 bis 32767 (wie die Firmware).     *
+ *              Ab # bis zum Zeilenende ist Kommentar.                        *
+ * Beispiel: musterbild muster.bin stern.txt                                  *
+\******************************************************************************/
+
+/***Header-Dateien*************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/******************************************************************************/
+
+#define KENNUNG         0x5053              // wie EXTERN_KENNUNG
+#define MUSTER_MAX      32                  // wie EXTERN_MUSTER_MAX
+#define GROESSE         0x00100000UL        // wie EXTERN_GROESSE
+#define DELAY_MOTOR     80                  // wie in Sandplotter.c
+#define DELAY_MAX       2000                // wie EXTERN_DELAY_MAX
+#define DELTA_MAX       32767               // Betrag muss in int passen
+
+static unsigned char Bild[GROESSE];
+static unsigned long Laenge;
+
+static void WORT(unsigned long Adresse, unsigned int Wert)
+{
+    Bild[Adresse] = Wert & 0xFF;
+    Bild[Adresse + 1] = (Wert >> 8) & 0xFF;
+}
+
+static void ANHAENGEN(unsigned int Wert, const char *Datei)
+{
+    if(Laenge + 2 > GROESSE)
+    {
+        fprintf(stderr, "musterbild: %s passt nicht mehr ins Flash\n", Datei);
+        exit(1);
+    }
+    WORT(Laenge, Wert);
+    Laenge += 2;
+}
+
+static int ZEILE(FILE *Datei, char *Zeile, int Groesse)  // nächste Zeile ohne Kommentar
+{
+    char *Kommentar;
+    int n;
+
+    while(fgets(Zeile, Groesse, Datei) != NULL)
+    {
+        Kommentar = strchr(Zeile, '#');
+        if(Kommentar != NULL)
+        {
+            *Kommentar = 0;
+        }
+        for(n=0;(Zeile[n] == ' ') || (Zeile[n] == '\t');n++)
+        {
+            //Leerzeichen
+        }
+        if((Zeile[n] != 0) && (Zeile[n] != '\n') && (Zeile[n] != '\r'))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int n, Muster, LED, Delay_max, Delta_x, Delta_y, Delay, Felder;
+    unsigned long Anfang, Anzahl;
+    char Zeile[256];
+    FILE *Datei;
+
+    Muster = argc - 2;
+    if((Muster < 1) || (Muster > MUSTER_MAX))
+    {
+        fprintf(stderr, "Aufruf: musterbild bild muster ... (1 bis %d Muster)\n", MUSTER_MAX);
+        return 1;
+    }
+    memset(Bild, 0xFF, sizeof(Bild));
+    WORT(0, KENNUNG);
+    WORT(2, Muster);
+    Laenge = 4 + 4UL*Muster;
+
+    for(n=0;n < Muster;n++)
+    {
+        Datei = fopen(argv[n + 2], "r");
+        if(Datei == NULL)
+        {
+            perror(argv[n + 2]);
+            return 1;
+        }
+        if((ZEILE(Datei, Zeile, sizeof(Zeile)) == 0) || (sscanf(Zeile, "%d %d", &LED, &Delay_max) != 2) ||
+           (LED < 0) || (LED > 255) || (Delay_max < DELAY_MOTOR) || (Delay_max > DELAY_MAX))
+        {
+            fprintf(stderr, "musterbild: %s: erste Zeile muss \"LED Delay_max\" sein (LED 0-255, Delay_max %d-%d)\n",
+                    argv[n + 2], DELAY_MOTOR, DELAY_MAX);
+            return 1;
+        }
+        Anfang = Laenge;
+        Bild[4 + 4*n] = Anfang & 0xFF;
+        Bild[5 + 4*n] = (Anfang >> 8) & 0xFF;
+        Bild[6 + 4*n] = (Anfang >> 16) & 0xFF;
+        Bild[7 + 4*n] = (Anfang >> 24) & 0xFF;
+        ANHAENGEN(LED & 0xFF, argv[n + 2]);
+        ANHAENGEN(Delay_max, argv[n + 2]);
+        ANHAENGEN(0, argv[n + 2]);          // Anzahl, wird unten eingetragen
+
+        Anzahl = 0;
+        while(ZEILE(Datei, Zeile, sizeof(Zeile)) == 1)
+        {
+            Delay = 0;
+            Felder = sscanf(Zeile, "%d %d %d", &Delta_x, &Delta_y, &Delay);
+            if((Felder < 2) || (Delta_x < -DELTA_MAX) || (Delta_x > DELTA_MAX) || (Delta_y < -DELTA_MAX) ||
+               (Delta_y > DELTA_MAX) || (Delay < 0) || (Delay > DELAY_MAX))
+            {
+                fprintf(stderr, "musterbild: %s: Teilstück %lu ungültig: %s", argv[n + 2], Anzahl + 1, Zeile);
+                return 1;
+            }
+            ANHAENGEN(Delta_x & 0xFFFF, argv[n + 2]);
+            ANHAENGEN(Delta_y & 0xFFFF, argv[n + 2]);
+            ANHAENGEN(Delay & 0xFFFF, argv[n + 2]);
+            Anzahl++;
+        }
+        fclose(Datei);
+        if(Anzahl > 0x7FFF)
+        {
+            fprintf(stderr, "musterbild: %s: mehr als 32767 Teilstücke\n", argv[n + 2]);
+            return 1;
+        }
+        WORT(Anfang + 4, Anzahl);
+        printf("Muster %d: %s, %lu Teilstücke ab 0x%06lX\n", n, argv[n + 2], Anzahl, Anfang);
+    }
+
+    Datei = fopen(argv[1], "wb");
+    if((Datei == NULL) || (fwrite(Bild, 1, Laenge, Datei) != Laenge))
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    fclose(Datei);
+    printf("%s: %lu Bytes\n", argv[1], Laenge);
+    return 0;
+}
@@ -0,0 +1,223 @@
+/******************************************************************************\
+ * File:        plotsim.c                                                     *
+ * Description: Lässt die Firmware (Sandplotter.c) auf dem PC gegen die       *
+ *              simulierte Hardware laufen und zeichnet die Schritte als      *
+ *              Spur auf (Eingabe für render).                                *
+ *                                                                            *
+ * Aufruf: plotsim [-o spur] [-f flash] [-m bild] [-l takte] [-s X,Y]         *
+ *                [-v ppm] [-t s] befehl ...                                  *
+ *   -o  Spur-Datei                                                           *
+ *   -f  Datei für den Programmspeicher (Sicherung bleibt zwischen Läufen)    *
+ *   -m  Abbild des SPI-Flash mit externen Mustern (siehe musterbild)         *
+ *   -l  zusätzliche Takte je SPI-Byte (langsames Flash)                      *
+ *   -s  wahre Startposition in Schritten (Vorgabe 2000,3000)                 *
+ *   -v  Schrittverlust in Schritten pro Million                              *
+ *   -t  Abbruch nach so vielen Sekunden simulierter Zeit (Vorgabe 7200)      *
+ * Befehle (der Reihe nach):                                                  *
+ *   reset logo spirale quadrat loeschen stopp ja nein                        *
+ *        Taste drücken (ja = Reset-, nein = Stopp-Taste), danach warten bis  *
+ *        die Motoren 1,5 s aus sind und die Firmware wieder die Tasten       *
+ *        abfragt.                                                            *
+ *        taste:ms hält die Taste ms lang (Vorgabe 100), taste@ms wartet      *
+ *        nach dem Loslassen ms lang statt auf Ruhe.                          *
+ *   warten:ms      so lange weiterlaufen                                     *
+ *   uart:text      Zeichen über UART2 schicken, gesendete Zeichen der        *
+ *                  Firmware erscheinen auf stdout (uart:? = Statistik,       *
+ *                  uart:M = nächstes Muster aus dem SPI-Flash)               *
+ * Beispiel: plotsim -o radieren.spur reset nein loeschen                     *
+\******************************************************************************/
+
+/***Header-Dateien*************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include "sim.h"
+/******************************************************************************/
+
+#define TAKTE_MS        500ULL
+#define RUHE            (1500*TAKTE_MS)
+
+/***Firmware*******************************************************************/
+int Sandplotter_main(void);
+extern int Position_X, Position_Y;
+/******************************************************************************/
+
+typedef struct
+{
+    const char *Name;
+    unsigned int Maske;
+} TASTE;
+
+static const TASTE Tasten[] =
+{
+    {"logo", 0x01}, {"spirale", 0x02}, {"quadrat", 0x04}, {"loeschen", 0x08},
+    {"reset", 0x10}, {"ja", 0x10}, {"stopp", 0x20}, {"nein", 0x20},
+};
+
+static char **Befehle;
+static int Anzahl, Nummer = -1;
+static unsigned long long Loslassen, Ende, Aus_seit, Grenze;
+static char Auf_Ruhe;
+static jmp_buf Fertig;
+
+static void NAECHSTER(void);
+
+static void ABLAUF(void)
+{
+    if(Sim.Zeit >= Grenze)
+    {
+        fprintf(stderr, "plotsim: Zeitgrenze erreicht (Befehl %d)\n", Nummer + 1);
+        longjmp(Fertig, 2);
+    }
+    if(SIM_MOTOREN_AN() || (Sim.Tasten != 0) || (Sim.Zeit - Sim.Tasten_gelesen > TAKTE_MS))
+    {
+        Aus_seit = Sim.Zeit;
+    }
+    if((Sim.Tasten != 0) && (Sim.Zeit >= Loslassen))
+    {
+        Sim.Tasten = 0;
+        Aus_seit = Sim.Zeit;
+    }
+    if(Sim.Tasten != 0)
+    {
+        return;
+    }
+    if(Auf_Ruhe ? (Sim.Zeit - Aus_seit >= RUHE) : (Sim.Zeit >= Ende))
+    {
+        NAECHSTER();
+    }
+}
+
+static void NAECHSTER(void)
+{
+    char Name[32];
+    const char *Befehl;
+    unsigned int n;
+    long Halten = 100, Danach = -1;
+
+    Nummer++;
+    if(Nummer >= Anzahl)
+    {
+        longjmp(Fertig, 1);
+    }
+    Befehl = Befehle[Nummer];
+    Auf_Ruhe = 0;
+    Ende = Sim.Zeit;
+
+    if(strncmp(Befehl, "uart:", 5) == 0)
+    {
+        SIM_UART(Befehl + 5);
+        Aus_seit = Sim.Zeit;
+        Auf_Ruhe = 1;                       // wie eine Taste: bis die Firmware wieder ruht
+        return;
+    }
+    if(strncmp(Befehl, "warten:", 7) == 0)
+    {
+        Ende = Sim.Zeit + atol(Befehl + 7)*TAKTE_MS;
+        return;
+    }
+
+    sscanf(Befehl, "%31[a-z]", Name);
+    if(strchr(Befehl, ':') != NULL)
+    {
+        Halten = atol(strchr(Befehl, ':') + 1);
+    }
+    if(strchr(Befehl, '@') != NULL)
+    {
+        Danach = atol(strchr(Befehl, '@') + 1);
+    }
+    for(n=0;n < sizeof(Tasten)/sizeof(Tasten[0]);n++)
+    {
+        if(strcmp(Name, Tasten[n].Name) == 0)
+        {
+            Sim.Tasten = Tasten[n].Maske;
+            Loslassen = Sim.Zeit + Halten*TAKTE_MS;
+            Aus_seit = Sim.Zeit;
+            Auf_Ruhe = (Danach < 0);
+            Ende = Loslassen + ((Danach < 0) ? 0 : Danach*TAKTE_MS);
+            return;
+        }
+    }
+    fprintf(stderr, "plotsim: unbekannter Befehl '%s'\n", Befehl);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    int n, Start_X = 2000, Start_Y = 3000, Ergebnis;
+    double Sekunden = 7200;
+    const char *Spur = NULL, *Flash = NULL, *Bild = NULL;
+
+    for(n=1;(n < argc) && (argv[n][0] == '-');n++)
+    {
+        if((argv[n][1] == 'o') && (n + 1 < argc))
+        {
+            Spur = argv[++n];
+        }
+        else if((argv[n][1] == 'f') && (n + 1 < argc))
+        {
+            Flash = argv[++n];
+        }
+        else if((argv[n][1] == 'm') && (n + 1 < argc))
+        {
+            Bild = argv[++n];
+        }
+        else if((argv[n][1] == 'l') && (n + 1 < argc))
+        {
+            Sim.Spi_Latenz = atol(argv[++n]);
+        }
+        else if((argv[n][1] == 's') && (n + 1 < argc))
+        {
+            sscanf(argv[++n], "%d,%d", &Start_X, &Start_Y);
+        }
+        else if((argv[n][1] == 'v') && (n + 1 < argc))
+        {
+            Sim.Verlust_ppm = atol(argv[++n]);
+        }
+        else if((argv[n][1] == 't') && (n + 1 < argc))
+        {
+            Sekunden = atof(argv[++n]);
+        }
+        else
+        {
+            fprintf(stderr, "Aufruf: plotsim [-o spur] [-f flash] [-m bild] [-l takte] [-s X,Y] [-v ppm] [-t s] befehl ...\n");
+            return 1;
+        }
+    }
+    Befehle = &argv[n];
+    Anzahl = argc - n;
+
+    Sim.Ablauf = ABLAUF;
+    Sim.Uart_Ausgabe = stdout;              // z. B. Statistik nach uart:?
+    SIM_START(Start_X, Start_Y);
+    Auf_Ruhe = 1;                           // Firmware erst hochlaufen lassen
+    Grenze = (unsigned long long)(Sekunden*500000);
+    if((Spur != NULL) && (SIM_SPUR(Spur) != 0))
+    {
+        perror(Spur);
+        return 1;
+    }
+    if((Flash != NULL) && (SIM_FLASH_DATEI(Flash) != 0))
+    {
+        perror(Flash);
+        return 1;
+    }
+    if((Bild != NULL) && (SIM_SPI_DATEI(Bild) != 0))
+    {
+        perror(Bild);
+        return 1;
+    }
+
+    Ergebnis = setjmp(Fertig);
+    if(Ergebnis == 0)
+    {
+        Sandplotter_main();
+    }
+    Sim.Ablauf = NULL;
+    SIM_SPUR_ENDE();
+
+    SIM_BERICHT(stdout);
+    printf("Firmware        X %d, Y %d\n", Position_X, Position_Y);
+    return (Ergebnis == 1) ? 0 : 1;
+}
@@ -0,0 +1,449 @@
+/******************************************************************************\
+ * File:        render.c                                                      *
+ * Description: Rechnet eine Spur von plotsim in ein Bild des Sandtischs um.  *
+ *              Die Kugel wird als Scheibe mit dem eingestellten Durchmesser  *
+ *              über die Bahn geschoben, das Bild wird in Kacheln auf mehrere *
+ *              Threads verteilt. Ausgegeben werden ein PGM-Bild, die         *
+ *              Abdeckung der Tischfläche und wie oft jeder Punkt überfahren  *
+ *              wurde.                                                        *
+ *                                                                            *
+ * Aufruf: render [-k kugel] [-m schritte] [-b breite,hoehe] [-j threads]     *
+ *                [-o bild.pgm] spur                                          *
+ *   -k  Kugeldurchmesser in Schritten (Vorgabe 250)                          *
+ *   -m  Schritte je Pixel (Vorgabe 4)                                        *
+ *   -b  Tischgröße in Schritten (Vorgabe 11200,11200)                        *
+ *   -j  Anzahl Threads (Vorgabe: alle Kerne)                                 *
+ *                                                                            *
+ * Ein Pixel zählt als neu überfahren, wenn die Kugel seit dem letzten        *
+ * Überfahren mehr als zwei Durchmesser Bahn zurückgelegt hat. Eine Gerade    *
+ * zählt so einmal, eine Wende auf der Stelle zweimal.                        *
+\******************************************************************************/
+
+/***Header-Dateien*************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+/******************************************************************************/
+
+#define KACHEL          64              // Zeilen je Kachel
+#define TOLERANZ        0.25            // Abweichung beim Vereinfachen in Pixeln
+
+/***Strukturen*****************************************************************/
+typedef struct
+{
+    float X0, Y0, X1, Y1;               // in Pixeln, y nach oben
+    float S0, S1;                       // Bahnlänge in Schritten
+    float Y_min, Y_max;                 // Zeilenbereich einschließlich Kugel
+} STRICH;
+/******************************************************************************/
+
+/***Globale Variablen**********************************************************/
+static STRICH *Striche;
+static long Strich_Anzahl, Strich_Platz;
+static int Breite, Hoehe;               // Bild in Pixeln
+static float Radius, Luecke;            // Kugel in Pixeln, Lücke in Schritten
+static unsigned int *Anzahl;            // Überfahrten je Pixel
+static float *Letzte;                   // Bahnlänge beim letzten Überfahren
+static int Kacheln, Naechste_Kachel;
+static pthread_mutex_t Sperre = PTHREAD_MUTEX_INITIALIZER;
+/******************************************************************************/
+
+static double JETZT(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+static void STRICH_ANHAENGEN(double X0, double Y0, double X1, double Y1, double S0, double S1, double Schritte)
+{
+    STRICH *s;
+
+    if(Strich_Anzahl == Strich_Platz)
+    {
+        Strich_Platz = (Strich_Platz == 0) ? 1024 : 2*Strich_Platz;
+        Striche = realloc(Striche, Strich_Platz*sizeof(STRICH));
+        if(Striche == NULL)
+        {
+            perror("render");
+            exit(1);
+        }
+    }
+    s = &Striche[Strich_Anzahl++];
+    s->X0 = X0/Schritte;
+    s->Y0 = Y0/Schritte;
+    s->X1 = X1/Schritte;
+    s->Y1 = Y1/Schritte;
+    s->S0 = S0;
+    s->S1 = S1;
+    s->Y_min = fmin(s->Y0, s->Y1) - Radius;
+    s->Y_max = fmax(s->Y0, s->Y1) + Radius;
+}
+
+/******************************************************************************\
+ * Function:    SPUR_LESEN                                                    *
+ * Description: Liest die Spur und fasst die Einzelschritte zu Strichen       *
+ *              zusammen, die höchstens TOLERANZ Pixel von der Bahn           *
+ *              abweichen (Winkelfenster vom Anfang des Strichs aus). Die     *
+ *              Bahnlänge wird aus den Einzelschritten aufsummiert.           *
+ * Return:      Anzahl Schritte, -1 bei Fehler                                *
+\******************************************************************************/
+static long SPUR_LESEN(const char *Datei, double Schritte)
+{
+    FILE *f;
+    unsigned char Kopf[8], Satz[8];
+    double Toleranz = TOLERANZ*Schritte;
+    double Anfang_X, Anfang_Y, Anfang_S, Ende_X, Ende_Y, Ende_S;
+    double X, Y, S, Alt_X, Alt_Y, Bezug = 0, Unten = 0, Oben = 0, Abstand, Winkel, w;
+    int Fenster = 0;
+    long n = 0;
+
+    f = fopen(Datei, "rb");
+    if(f == NULL)
+    {
+        perror(Datei);
+        return -1;
+    }
+    if((fread(Kopf, 1, 8, f) != 8) || (memcmp(Kopf, "SPUR", 4) != 0) || (Kopf[4] != 1))
+    {
+        fprintf(stderr, "render: %s ist keine Spur\n", Datei);
+        fclose(f);
+        return -1;
+    }
+
+    Anfang_X = Anfang_Y = Anfang_S = Ende_X = Ende_Y = Ende_S = 0;
+    Alt_X = Alt_Y = S = 0;
+    while(fread(Satz, 1, 8, f) == 8)
+    {
+        X = (short)(Satz[4] | (Satz[5] << 8));
+        Y = (short)(Satz[6] | (Satz[7] << 8));
+        if(n == 0)
+        {
+            Anfang_X = Ende_X = Alt_X = X;
+            Anfang_Y = Ende_Y = Alt_Y = Y;
+        }
+        S += hypot(X - Alt_X, Y - Alt_Y);
+        Alt_X = X;
+        Alt_Y = Y;
+        n++;
+
+        for(;;)
+        {
+            Abstand = hypot(X - Anfang_X, Y - Anfang_Y);
+            if(Abstand <= Toleranz)
+            {
+                break;
+            }
+            Winkel = atan2(Y - Anfang_Y, X - Anfang_X);
+            if(Fenster == 0)
+            {
+                Bezug = Winkel;
+                Unten = -M_PI;
+                Oben = M_PI;
+                Fenster = 1;
+            }
+            Winkel = remainder(Winkel - Bezug, 2*M_PI);
+            if((Winkel >= Unten) && (Winkel <= Oben))
+            {
+                w = asin(Toleranz/Abstand);
+                Unten = fmax(Unten, Winkel - w);
+                Oben = fmin(Oben, Winkel + w);
+                break;
+            }
+            // Punkt liegt außerhalb: Strich bis zum letzten Punkt abschließen
+            STRICH_ANHAENGEN(Anfang_X, Anfang_Y, Ende_X, Ende_Y, Anfang_S, Ende_S, Schritte);
+            Anfang_X = Ende_X;
+            Anfang_Y = Ende_Y;
+            Anfang_S = Ende_S;
+            Fenster = 0;
+        }
+        Ende_X = X;
+        Ende_Y = Y;
+        Ende_S = S;
+    }
+    fclose(f);
+    if(n > 0)
+    {
+        STRICH_ANHAENGEN(Anfang_X, Anfang_Y, Ende_X, Ende_Y, Anfang_S, Ende_S, Schritte);
+    }
+    return n;
+}
+
+/******************************************************************************\
+ * Function:    ZEILE_FUELLEN                                                 *
+ * Description: Überfährt in einer Zeile alle Pixel, deren Mitte höchstens    *
+ *              Radius vom Strich entfernt ist. Die Fläche ist eine Kapsel,   *
+ *              ihr Schnitt mit der Zeile also ein Intervall aus den beiden   *
+ *              Endkreisen und dem Band dazwischen.                           *
+\******************************************************************************/
+static void ZEILE_FUELLEN(const STRICH *s, int j)
+{
+    float yc = j + 0.5f, dx = s->X1 - s->X0, dy = s->Y1 - s->Y0;
+    float L2 = dx*dx + dy*dy, L, a, b, h, Links = 1e30f, Rechts = -1e30f;
+    float t0 = 0, dt = 0, dS = s->S1 - s->S0, t, S;
+    unsigned int *Zeile_Anzahl = &Anzahl[(long)j*Breite];
+    float *Zeile_Letzte = &Letzte[(long)j*Breite];
+    int i, i_a, i_b;
+
+    h = Radius*Radius - (yc - s->Y0)*(yc - s->Y0);
+    if(h >= 0)
+    {
+        h = sqrtf(h);
+        Links = s->X0 - h;
+        Rechts = s->X0 + h;
+    }
+    h = Radius*Radius - (yc - s->Y1)*(yc - s->Y1);
+    if(h >= 0)
+    {
+        h = sqrtf(h);
+        Links = fminf(Links, s->X1 - h);
+        Rechts = fmaxf(Rechts, s->X1 + h);
+    }
+    if(L2 > 0)
+    {
+        L = sqrtf(L2);
+        a = -1e30f;
+        b = 1e30f;
+        // Band: |(x - X0)*dy - (yc - Y0)*dx| <= Radius*L
+        if(dy != 0)
+        {
+            float m = s->X0 + (yc - s->Y0)*dx/dy, r = fabsf(Radius*L/dy);
+
+            a = m - r;
+            b = m + r;
+        }
+        else if(fabsf(yc - s->Y0) > Radius)
+        {
+            a = 1e30f;
+        }
+        // Projektion auf den Strich zwischen 0 und 1
+        if(dx != 0)
+        {
+            float p0 = s->X0 - (yc - s->Y0)*dy/dx, p1 = s->X0 + (L2 - (yc - s->Y0)*dy)/dx;
+
+            a = fmaxf(a, fminf(p0, p1));
+            b = fminf(b, fmaxf(p0, p1));
+        }
+        else
+        {
+            t = (yc - s->Y0)*dy/L2;
+            if((t < 0) || (t > 1))
+            {
+                a = 1e30f;
+            }
+        }
+        if(a <= b)
+        {
+            Links = fminf(Links, a);
+            Rechts = fmaxf(Rechts, b);
+        }
+        dt = dx/L2;
+        t0 = ((0.5f - s->X0)*dx + (yc - s->Y0)*dy)/L2;
+    }
+    if(Links > Rechts)
+    {
+        return;
+    }
+    i_a = (int)ceilf(Links - 0.5f);
+    i_b = (int)floorf(Rechts - 0.5f);
+    if(i_a < 0)
+    {
+        i_a = 0;
+    }
+    if(i_b > Breite - 1)
+    {
+        i_b = Breite - 1;
+    }
+    for(i=i_a;i <= i_b;i++)
+    {
+        t = t0 + dt*i;
+        t = (t < 0) ? 0 : ((t > 1) ? 1 : t);
+        S = s->S0 + dS*t;
+        Zeile_Anzahl[i] += (S - Zeile_Letzte[i] > Luecke);
+        Zeile_Letzte[i] = S;
+    }
+}
+
+/******************************************************************************\
+ * Function:    ARBEITER                                                      *
+ * Description: Holt sich Kacheln, bis alle gezeichnet sind. Innerhalb einer  *
+ *              Kachel laufen die Striche in Bahnreihenfolge, die Kacheln     *
+ *              sind voneinander unabhängig.                                  *
+\******************************************************************************/
+static void *ARBEITER(void *Unbenutzt)
+{
+    int k, j, j_a, j_b;
+    long n;
+
+    (void)Unbenutzt;
+    for(;;)
+    {
+        pthread_mutex_lock(&Sperre);
+        k = Naechste_Kachel++;
+        pthread_mutex_unlock(&Sperre);
+        if(k >= Kacheln)
+        {
+            return NULL;
+        }
+        for(n=0;n < Strich_Anzahl;n++)
+        {
+            const STRICH *s = &Striche[n];
+
+            j_a = (int)ceilf(s->Y_min - 0.5f);
+            j_b = (int)floorf(s->Y_max - 0.5f);
+            if(j_a < k*KACHEL)
+            {
+                j_a = k*KACHEL;
+            }
+            if(j_b > (k + 1)*KACHEL - 1)
+            {
+                j_b = (k + 1)*KACHEL - 1;
+            }
+            if(j_b > Hoehe - 1)
+            {
+                j_b = Hoehe - 1;
+            }
+            for(j=j_a;j <= j_b;j++)
+            {
+                ZEILE_FUELLEN(s, j);
+            }
+        }
+    }
+}
+
+static int BILD_SCHREIBEN(const char *Datei)
+{
+    static const unsigned char Grau[5] = {225, 140, 100, 70, 45};
+    unsigned char *Zeile = malloc(Breite);
+    FILE *f = fopen(Datei, "wb");
+    int i, j;
+
+    if((f == NULL) || (Zeile == NULL))
+    {
+        perror(Datei);
+        return 1;
+    }
+    fprintf(f, "P5\n%d %d\n255\n", Breite, Hoehe);
+    for(j=Hoehe - 1;j >= 0;j--)
+    {
+        for(i=0;i < Breite;i++)
+        {
+            unsigned int a = Anzahl[(long)j*Breite + i];
+
+            Zeile[i] = Grau[(a > 4) ? 4 : a];
+        }
+        fwrite(Zeile, 1, Breite, f);
+    }
+    free(Zeile);
+    return fclose(f) != 0;
+}
+
+int main(int argc, char **argv)
+{
+    double Kugel = 250, Schritte = 4, Tisch_X = 11200, Tisch_Y = 11200, t0, t1, t2;
+    const char *Bild = NULL;
+    int n, Threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    long Pixel, i, Bedeckt = 0, Summe = 0, Histogramm[5] = {0};
+    long Schritt_Anzahl;
+    pthread_t *Liste;
+
+    for(n=1;(n < argc - 1) && (argv[n][0] == '-');n++)
+    {
+        if(argv[n][1] == 'k')
+        {
+            Kugel = atof(argv[++n]);
+        }
+        else if(argv[n][1] == 'm')
+        {
+            Schritte = atof(argv[++n]);
+        }
+        else if(argv[n][1] == 'b')
+        {
+            sscanf(argv[++n], "%lf,%lf", &Tisch_X, &Tisch_Y);
+        }
+        else if(argv[n][1] == 'j')
+        {
+            Threads = atoi(argv[++n]);
+        }
+        else if(argv[n][1] == 'o')
+        {
+            Bild = argv[++n];
+        }
+        else
+        {
+            break;
+        }
+    }
+    if((n != argc - 1) || (Schritte <= 0) || (Kugel <= 0))
+    {
+        fprintf(stderr, "Aufruf: render [-k kugel] [-m schritte] [-b breite,hoehe] [-j threads] [-o bild.pgm] spur\n");
+        return 1;
+    }
+    if(Threads < 1)
+    {
+        Threads = 1;
+    }
+
+    Breite = (int)ceil(Tisch_X/Schritte);
+    Hoehe = (int)ceil(Tisch_Y/Schritte);
+    Radius = Kugel/Schritte/2;
+    Luecke = 2*Kugel;
+    Pixel = (long)Breite*Hoehe;
+    Anzahl = calloc(Pixel, sizeof(*Anzahl));
+    Letzte = malloc(Pixel*sizeof(*Letzte));
+    Liste = malloc(Threads*sizeof(*Liste));
+    if((Anzahl == NULL) || (Letzte == NULL) || (Liste == NULL))
+    {
+        perror("render");
+        return 1;
+    }
+    for(i=0;i < Pixel;i++)
+    {
+        Letzte[i] = -1e30f;
+    }
+
+    t0 = JETZT();
+    Schritt_Anzahl = SPUR_LESEN(argv[n], Schritte);
+    if(Schritt_Anzahl < 0)
+    {
+        return 1;
+    }
+    t1 = JETZT();
+
+    Kacheln = (Hoehe + KACHEL - 1)/KACHEL;
+    for(n=0;n < Threads;n++)
+    {
+        pthread_create(&Liste[n], NULL, ARBEITER, NULL);
+    }
+    for(n=0;n < Threads;n++)
+    {
+        pthread_join(Liste[n], NULL);
+    }
+    t2 = JETZT();
+
+    for(i=0;i < Pixel;i++)
+    {
+        Histogramm[(Anzahl[i] > 4) ? 4 : Anzahl[i]]++;
+        Bedeckt += (Anzahl[i] != 0);
+        Summe += Anzahl[i];
+    }
+    printf("Spur            %ld Schritte, %ld Striche\n", Schritt_Anzahl, Strich_Anzahl);
+    printf("Bild            %d x %d Pixel, Kugel %.0f Schritte, %d Threads\n", Breite, Hoehe, Kugel, Threads);
+    printf("Abdeckung       %.2f %%\n", 100.0*Bedeckt/Pixel);
+    printf("Überfahrten     %.2f im Mittel der bedeckten Fläche\n", Bedeckt ? (double)Summe/Bedeckt : 0.0);
+    printf("Verteilung      0: %.2f %%  1: %.2f %%  2: %.2f %%  3: %.2f %%  4+: %.2f %%\n",
+           100.0*Histogramm[0]/Pixel, 100.0*Histogramm[1]/Pixel, 100.0*Histogramm[2]/Pixel,
+           100.0*Histogramm[3]/Pixel, 100.0*Histogramm[4]/Pixel);
+    printf("Zeit            Lesen %.3f s, Zeichnen %.3f s\n", t1 - t0, t2 - t1);
+
+    if((Bild != NULL) && (BILD_SCHREIBEN(Bild) != 0))
+    {
+        return 1;
+    }
+    return 0;
+}